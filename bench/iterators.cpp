@@ -0,0 +1,122 @@
+// Compares the pointer tuple iterators (one pointer per member) with the indexed iterators
+// (column table pointer + single index) on a wide table.
+//
+// Build: g++ -O2 -std=c++17 -I include bench/iterators.cpp -o iterators_bench
+// Usage: iterators_bench [rows] [repetitions]
+
+#include "soa/soa.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+enum class Entity
+{
+    PositionX,
+    PositionY,
+    PositionZ,
+    VelocityX,
+    VelocityY,
+    VelocityZ,
+    Mass,
+    Drag,
+    Health,
+    Flags,
+    Team,
+    Score,
+    Count
+};
+
+using EntityArray = soa::vector<Entity, float, float, float, float, float, float, float, float, float, int, int, int>;
+
+// Prevents the compiler from discarding a computed value
+template<typename T>
+void keep(const T& _value)
+{
+    [[maybe_unused]] static volatile T sink;
+    sink = _value;
+}
+
+template<typename Function>
+double best_ns_per_row(size_t _rows, size_t _repetitions, Function&& _function)
+{
+    double best{ 1e300 };
+    for (size_t i = 0; i < _repetitions; ++i)
+    {
+        const auto start{ std::chrono::steady_clock::now() };
+        _function();
+        const auto end{ std::chrono::steady_clock::now() };
+        const double ns{ std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(_rows) };
+        best = ns < best ? ns : best;
+    }
+    return best;
+}
+
+// Integrates the positions from the velocities: 7 members read, 3 written
+template<typename Iterator>
+void integrate(Iterator _it, Iterator _end)
+{
+    constexpr float dt{ 1.f / 60.f };
+    for (; _it != _end; ++_it)
+    {
+        const float drag{ 1.f - _it.template value<Entity::Drag>() * dt };
+        _it.template value<Entity::PositionX>() += _it.template value<Entity::VelocityX>() * drag * dt;
+        _it.template value<Entity::PositionY>() += _it.template value<Entity::VelocityY>() * drag * dt;
+        _it.template value<Entity::PositionZ>() += _it.template value<Entity::VelocityZ>() * drag * dt;
+    }
+}
+
+// Reads the 12 members of every row
+template<typename Iterator>
+float read_all(Iterator _it, Iterator _end)
+{
+    float sum{};
+    for (; _it != _end; ++_it)
+    {
+        sum += _it.template value<Entity::PositionX>() + _it.template value<Entity::PositionY>() + _it.template value<Entity::PositionZ>()
+            + _it.template value<Entity::VelocityX>() + _it.template value<Entity::VelocityY>() + _it.template value<Entity::VelocityZ>()
+            + _it.template value<Entity::Mass>() + _it.template value<Entity::Drag>() + _it.template value<Entity::Health>()
+            + static_cast<float>(_it.template value<Entity::Flags>() + _it.template value<Entity::Team>() + _it.template value<Entity::Score>());
+    }
+    return sum;
+}
+
+int main(int _argc, char** _argv)
+{
+    const size_t rows{ _argc > 1 ? std::strtoull(_argv[1], nullptr, 10) : 1'000'000 };
+    const size_t repetitions{ _argc > 2 ? std::strtoull(_argv[2], nullptr, 10) : 10 };
+
+    EntityArray entities;
+    entities.reserve(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        const float f{ static_cast<float>(i % 1024) };
+        entities.push_back(f, f, f, 1.f, 2.f, 3.f, 10.f, 0.1f, 100.f, 0, static_cast<int>(i % 4), 0);
+    }
+
+    std::printf("%zu rows, %d members, best of %zu runs (ns/row)\n", rows, static_cast<int>(EntityArray::members_count), repetitions);
+    std::printf("%-32s %12s %12s\n", "", "pointers", "indexed");
+
+    const double integratePointers{ best_ns_per_row(rows, repetitions, [&] {
+        integrate(
+            entities.begin<Entity::PositionX, Entity::PositionY, Entity::PositionZ, Entity::VelocityX, Entity::VelocityY, Entity::VelocityZ, Entity::Drag>(),
+            entities.end<Entity::PositionX, Entity::PositionY, Entity::PositionZ, Entity::VelocityX, Entity::VelocityY, Entity::VelocityZ, Entity::Drag>());
+    }) };
+    const double integrateIndexed{ best_ns_per_row(rows, repetitions, [&] {
+        integrate(
+            entities.indexed_begin<Entity::PositionX, Entity::PositionY, Entity::PositionZ, Entity::VelocityX, Entity::VelocityY, Entity::VelocityZ, Entity::Drag>(),
+            entities.indexed_end<Entity::PositionX, Entity::PositionY, Entity::PositionZ, Entity::VelocityX, Entity::VelocityY, Entity::VelocityZ, Entity::Drag>());
+    }) };
+    std::printf("%-32s %12.3f %12.3f\n", "integrate (7 members)", integratePointers, integrateIndexed);
+
+    const double readPointers{ best_ns_per_row(rows, repetitions, [&] {
+        keep(read_all(std::as_const(entities).begin(), std::as_const(entities).end()));
+    }) };
+    const double readIndexed{ best_ns_per_row(rows, repetitions, [&] {
+        keep(read_all(entities.indexed_cbegin(), entities.indexed_cend()));
+    }) };
+    std::printf("%-32s %12.3f %12.3f\n", "read all (12 members)", readPointers, readIndexed);
+
+    return 0;
+}
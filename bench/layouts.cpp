@@ -0,0 +1,129 @@
+// Compares the column layout of soa::vector with the tiled layout of soa::tiled_vector (AoSoA),
+// through the same partial iterators, and tile by tile on contiguous arrays.
+//
+// Build: g++ -O2 -std=c++17 -I include bench/layouts.cpp -o layouts_bench
+// Usage: layouts_bench [rows] [repetitions]
+
+#include "soa/soa.h"
+#include "soa/tiled_vector.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+enum class Entity
+{
+    PositionX,
+    PositionY,
+    PositionZ,
+    VelocityX,
+    VelocityY,
+    VelocityZ,
+    Mass,
+    Drag,
+    Health,
+    Flags,
+    Team,
+    Score,
+    Count
+};
+
+#define ENTITY_TYPES float, float, float, float, float, float, float, float, float, int, int, int
+
+using EntityArray = soa::vector<Entity, ENTITY_TYPES>;
+using EntityTiles8 = soa::tiled_vector_base<Entity, soa::std_allocator, 8, ENTITY_TYPES>;
+using EntityTiles16 = soa::tiled_vector_base<Entity, soa::std_allocator, 16, ENTITY_TYPES>;
+
+template<typename Function>
+double best_ns_per_row(size_t _rows, size_t _repetitions, Function&& _function)
+{
+    double best{ 1e300 };
+    for (size_t i = 0; i < _repetitions; ++i)
+    {
+        const auto start{ std::chrono::steady_clock::now() };
+        _function();
+        const auto end{ std::chrono::steady_clock::now() };
+        const double ns{ std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(_rows) };
+        best = ns < best ? ns : best;
+    }
+    return best;
+}
+
+template<typename Container>
+void fill(Container& _entities, size_t _rows)
+{
+    _entities.reserve(_rows);
+    for (size_t i = 0; i < _rows; ++i)
+    {
+        const float f{ static_cast<float>(i % 1024) };
+        _entities.push_back(f, f, f, 1.f, 2.f, 3.f, 10.f, 0.1f, 100.f, 0, static_cast<int>(i % 4), 0);
+    }
+}
+
+// Integrates the positions from the velocities: 7 members read, 3 written
+template<typename Container>
+void integrate(Container& _entities)
+{
+    constexpr float dt{ 1.f / 60.f };
+    auto it{ _entities.template begin<Entity::PositionX, Entity::PositionY, Entity::PositionZ, Entity::VelocityX, Entity::VelocityY, Entity::VelocityZ, Entity::Drag>() };
+    const auto end{ _entities.template end<Entity::PositionX, Entity::PositionY, Entity::PositionZ, Entity::VelocityX, Entity::VelocityY, Entity::VelocityZ, Entity::Drag>() };
+    for (; it != end; ++it)
+    {
+        const float drag{ 1.f - it.template value<Entity::Drag>() * dt };
+        it.template value<Entity::PositionX>() += it.template value<Entity::VelocityX>() * drag * dt;
+        it.template value<Entity::PositionY>() += it.template value<Entity::VelocityY>() * drag * dt;
+        it.template value<Entity::PositionZ>() += it.template value<Entity::VelocityZ>() * drag * dt;
+    }
+}
+
+// Same kernel, processing each tile as a set of contiguous arrays
+template<typename Container>
+void integrate_tiles(Container& _entities)
+{
+    constexpr float dt{ 1.f / 60.f };
+    for (size_t tile = 0; tile < _entities.tile_count(); ++tile)
+    {
+        float* px{ _entities.template column<Entity::PositionX>(tile).data() };
+        float* py{ _entities.template column<Entity::PositionY>(tile).data() };
+        float* pz{ _entities.template column<Entity::PositionZ>(tile).data() };
+        const float* vx{ _entities.template column<Entity::VelocityX>(tile).data() };
+        const float* vy{ _entities.template column<Entity::VelocityY>(tile).data() };
+        const float* vz{ _entities.template column<Entity::VelocityZ>(tile).data() };
+        const float* drags{ _entities.template column<Entity::Drag>(tile).data() };
+        const size_t count{ _entities.template column<Entity::Drag>(tile).size() };
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float drag{ 1.f - drags[i] * dt };
+            px[i] += vx[i] * drag * dt;
+            py[i] += vy[i] * drag * dt;
+            pz[i] += vz[i] * drag * dt;
+        }
+    }
+}
+
+int main(int _argc, char** _argv)
+{
+    const size_t rows{ _argc > 1 ? std::strtoull(_argv[1], nullptr, 10) : 1'000'000 };
+    const size_t repetitions{ _argc > 2 ? std::strtoull(_argv[2], nullptr, 10) : 10 };
+
+    EntityArray columns;
+    EntityTiles8 tiles8;
+    EntityTiles16 tiles16;
+    fill(columns, rows);
+    fill(tiles8, rows);
+    fill(tiles16, rows);
+
+    std::printf("%zu rows, %d members, best of %zu runs (ns/row)\n", rows, static_cast<int>(EntityArray::members_count), repetitions);
+    std::printf("%-40s %12s %12s %12s\n", "", "columns", "tiles of 8", "tiles of 16");
+
+    const double iteratorColumns{ best_ns_per_row(rows, repetitions, [&] { integrate(columns); }) };
+    const double iteratorTiles8{ best_ns_per_row(rows, repetitions, [&] { integrate(tiles8); }) };
+    const double iteratorTiles16{ best_ns_per_row(rows, repetitions, [&] { integrate(tiles16); }) };
+    std::printf("%-40s %12.3f %12.3f %12.3f\n", "integrate, iterators (7 members)", iteratorColumns, iteratorTiles8, iteratorTiles16);
+
+    const double tileTiles8{ best_ns_per_row(rows, repetitions, [&] { integrate_tiles(tiles8); }) };
+    const double tileTiles16{ best_ns_per_row(rows, repetitions, [&] { integrate_tiles(tiles16); }) };
+    std::printf("%-40s %12s %12.3f %12.3f\n", "integrate, tile by tile (7 members)", "", tileTiles8, tileTiles16);
+
+    return 0;
+}
@@ -0,0 +1,341 @@
+// Compares soa::vector with the equivalent std::vector of structures (AoS) on the core operations,
+// for a narrow (4 members, 16 bytes) and a wide (16 members, 64 bytes) row, at several row counts.
+// Times are the best of the repetitions, in ns per row (or per operation for insert/erase), with the
+// SoA/AoS ratio: below 1, the structure of arrays is faster. Random access reads shuffled rows,
+// so it is dominated by cache misses once the table doesn't fit in the caches.
+//
+// Build: cmake -S . -B build -DCMAKE_BUILD_TYPE=Release && cmake --build build --target operations_bench
+// Usage: operations_bench [max rows] [repetitions]
+//        row counts go from 1K to max rows (10M by default, 100M needs ~13GB), by factors of 10
+
+#include "soa/soa.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Prevents the compiler from discarding a computed value
+template<typename T>
+void keep(const T& _value)
+{
+    [[maybe_unused]] static volatile T sink;
+    sink = _value;
+}
+
+template<typename Function>
+double best_ns(size_t _count, size_t _repetitions, Function&& _function)
+{
+    double best{ 1e300 };
+    for (size_t i = 0; i < _repetitions; ++i)
+    {
+        const auto start{ std::chrono::steady_clock::now() };
+        _function();
+        const auto end{ std::chrono::steady_clock::now() };
+        const double ns{ std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(_count) };
+        best = ns < best ? ns : best;
+    }
+    return best;
+}
+
+// Same as best_ns, with a setup excluded from the timing
+template<typename Setup, typename Function>
+double best_ns(size_t _count, size_t _repetitions, Setup&& _setup, Function&& _function)
+{
+    double best{ 1e300 };
+    for (size_t i = 0; i < _repetitions; ++i)
+    {
+        _setup();
+        const auto start{ std::chrono::steady_clock::now() };
+        _function();
+        const auto end{ std::chrono::steady_clock::now() };
+        const double ns{ std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(_count) };
+        best = ns < best ? ns : best;
+    }
+    return best;
+}
+
+// Narrow rows: a position and an identifier
+struct Narrow
+{
+    float x, y, z;
+    int id;
+};
+
+enum class NarrowMembers
+{
+    X,
+    Y,
+    Z,
+    Id,
+    Count
+};
+
+// Wide rows: the same members, and a 48 bytes payload
+struct Wide
+{
+    float x, y, z;
+    int id;
+    float payload[12];
+};
+
+enum class WideMembers
+{
+    X,
+    Y,
+    Z,
+    Id,
+    P0,
+    P1,
+    P2,
+    P3,
+    P4,
+    P5,
+    P6,
+    P7,
+    P8,
+    P9,
+    P10,
+    P11,
+    Count
+};
+
+// Both layouts of each row type, with the operations which depend on the members
+struct NarrowLayouts
+{
+    static constexpr const char* name{ "narrow (16B)" };
+    using aos = std::vector<Narrow>;
+    using soa = soa::vector<NarrowMembers, float, float, float, int>;
+    using members = NarrowMembers;
+
+    static Narrow make_row(size_t _index, int _id)
+    {
+        const float f{ static_cast<float>(_index % 1024) };
+        return { f, f, f, _id };
+    }
+
+    static void push_back(aos& _rows, const Narrow& _row)
+    {
+        _rows.push_back(_row);
+    }
+
+    static void push_back(soa& _rows, const Narrow& _row)
+    {
+        _rows.push_back(_row.x, _row.y, _row.z, _row.id);
+    }
+
+    static void insert(aos& _rows, size_t _pos, const Narrow& _row)
+    {
+        _rows.insert(_rows.begin() + static_cast<std::ptrdiff_t>(_pos), _row);
+    }
+
+    static void insert(soa& _rows, size_t _pos, const Narrow& _row)
+    {
+        _rows.insert(_pos, _row.x, _row.y, _row.z, _row.id);
+    }
+
+    static float sum_all(const Narrow& _row)
+    {
+        return _row.x + _row.y + _row.z + static_cast<float>(_row.id);
+    }
+};
+
+struct WideLayouts
+{
+    static constexpr const char* name{ "wide (64B)" };
+    using aos = std::vector<Wide>;
+    using soa = soa::vector<WideMembers, float, float, float, int, float, float, float, float, float, float, float, float, float, float, float, float>;
+    using members = WideMembers;
+
+    static Wide make_row(size_t _index, int _id)
+    {
+        const float f{ static_cast<float>(_index % 1024) };
+        return { f, f, f, _id, { f, f, f, f, f, f, f, f, f, f, f, f } };
+    }
+
+    static void push_back(aos& _rows, const Wide& _row)
+    {
+        _rows.push_back(_row);
+    }
+
+    static void push_back(soa& _rows, const Wide& _row)
+    {
+        const float* p{ _row.payload };
+        _rows.push_back(_row.x, _row.y, _row.z, _row.id, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8], p[9], p[10], p[11]);
+    }
+
+    static void insert(aos& _rows, size_t _pos, const Wide& _row)
+    {
+        _rows.insert(_rows.begin() + static_cast<std::ptrdiff_t>(_pos), _row);
+    }
+
+    static void insert(soa& _rows, size_t _pos, const Wide& _row)
+    {
+        const float* p{ _row.payload };
+        _rows.insert(_pos, _row.x, _row.y, _row.z, _row.id, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], p[8], p[9], p[10], p[11]);
+    }
+
+    static float sum_all(const Wide& _row)
+    {
+        float sum{ _row.x + _row.y + _row.z + static_cast<float>(_row.id) };
+        for (float value : _row.payload)
+            sum += value;
+        return sum;
+    }
+};
+
+void print_result(const char* _operation, const char* _width, size_t _rows, double _aos, double _soa)
+{
+    std::printf("%-22s %-14s %12zu %12.3f %12.3f %8.2f %12.1f\n", _operation, _width, _rows, _aos, _soa, _soa / _aos, 1e3 / _soa);
+}
+
+template<typename Layouts>
+void run(size_t _rows, size_t _repetitions)
+{
+    using aos = typename Layouts::aos;
+    using soa = typename Layouts::soa;
+    using members = typename Layouts::members;
+    const char* width{ Layouts::name };
+
+    std::mt19937 random{ 42 };
+    std::vector<int> ids(_rows);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::shuffle(ids.begin(), ids.end(), random);
+
+    // push_back, with and without reserve
+    {
+        aos aosRows;
+        soa soaRows;
+        const double aosGrow{ best_ns(_rows, _repetitions, [&] { aos{}.swap(aosRows); }, [&] {
+            for (size_t i = 0; i < _rows; ++i)
+                Layouts::push_back(aosRows, Layouts::make_row(i, ids[i]));
+        }) };
+        const double soaGrow{ best_ns(_rows, _repetitions, [&] { soaRows = soa{}; }, [&] {
+            for (size_t i = 0; i < _rows; ++i)
+                Layouts::push_back(soaRows, Layouts::make_row(i, ids[i]));
+        }) };
+        print_result("push_back", width, _rows, aosGrow, soaGrow);
+
+        const double aosReserved{ best_ns(_rows, _repetitions, [&] { aos{}.swap(aosRows); }, [&] {
+            aosRows.reserve(_rows);
+            for (size_t i = 0; i < _rows; ++i)
+                Layouts::push_back(aosRows, Layouts::make_row(i, ids[i]));
+        }) };
+        const double soaReserved{ best_ns(_rows, _repetitions, [&] { soaRows = soa{}; }, [&] {
+            soaRows.reserve(_rows);
+            for (size_t i = 0; i < _rows; ++i)
+                Layouts::push_back(soaRows, Layouts::make_row(i, ids[i]));
+        }) };
+        print_result("reserve + push_back", width, _rows, aosReserved, soaReserved);
+    }
+
+    aos aosRows;
+    soa soaRows;
+    aosRows.reserve(_rows);
+    soaRows.reserve(_rows);
+    for (size_t i = 0; i < _rows; ++i)
+    {
+        Layouts::push_back(aosRows, Layouts::make_row(i, ids[i]));
+        Layouts::push_back(soaRows, Layouts::make_row(i, ids[i]));
+    }
+
+    // Reads all the members of every row
+    {
+        const double aosTime{ best_ns(_rows, _repetitions, [&] {
+            float sum{};
+            for (const auto& row : aosRows)
+                sum += Layouts::sum_all(row);
+            keep(sum);
+        }) };
+        const double soaTime{ best_ns(_rows, _repetitions, [&] {
+            float sum{};
+            for (auto it = soaRows.cbegin(); it != soaRows.cend(); ++it)
+                sum += std::apply([](const auto&... _members) { return (static_cast<float>(_members) + ...); }, *it);
+            keep(sum);
+        }) };
+        print_result("iterate all members", width, _rows, aosTime, soaTime);
+    }
+
+    // Updates one member from another
+    {
+        const double aosTime{ best_ns(_rows, _repetitions, [&] {
+            for (auto& row : aosRows)
+                row.x += static_cast<float>(row.id) * 0.5f;
+        }) };
+        const double soaTime{ best_ns(_rows, _repetitions, [&] {
+            const auto end{ soaRows.template end<members::X, members::Id>() };
+            for (auto it = soaRows.template begin<members::X, members::Id>(); it != end; ++it)
+                it.template value<members::X>() += static_cast<float>(it.template value<members::Id>()) * 0.5f;
+        }) };
+        print_result("iterate 2 members", width, _rows, aosTime, soaTime);
+    }
+
+    // Reads one member of shuffled rows, through the checked accessors
+    {
+        const double aosTime{ best_ns(_rows, _repetitions, [&] {
+            float sum{};
+            for (size_t i = 0; i < _rows; ++i)
+                sum += aosRows.at(static_cast<size_t>(ids[i])).x;
+            keep(sum);
+        }) };
+        const double soaTime{ best_ns(_rows, _repetitions, [&] {
+            float sum{};
+            for (size_t i = 0; i < _rows; ++i)
+                sum += soaRows.template at<members::X>(static_cast<size_t>(ids[i]));
+            keep(sum);
+        }) };
+        print_result("at<> random", width, _rows, aosTime, soaTime);
+    }
+
+    // Sorts the rows on the shuffled identifier
+    {
+        aos aosSorted;
+        soa soaSorted;
+        const double aosTime{ best_ns(_rows, _repetitions, [&] { aosSorted = aosRows; }, [&] {
+            std::sort(aosSorted.begin(), aosSorted.end(), [](const auto& _lhs, const auto& _rhs) { return _lhs.id < _rhs.id; });
+        }) };
+        const double soaTime{ best_ns(_rows, _repetitions, [&] { soaSorted = soaRows; }, [&] {
+            soaSorted.template sort<members::Id>();
+        }) };
+        print_result("sort on 1 member", width, _rows, aosTime, soaTime);
+    }
+
+    // Inserts then erases rows in the middle: linear in the number of rows, so limited to 1M rows
+    if (_rows <= 1'000'000)
+    {
+        constexpr size_t operations{ 64 };
+        const double aosTime{ best_ns(operations, _repetitions, [&] {
+            for (size_t i = 0; i < operations; ++i)
+                Layouts::insert(aosRows, _rows / 2, Layouts::make_row(i, 0));
+            for (size_t i = 0; i < operations; ++i)
+                aosRows.erase(aosRows.begin() + static_cast<std::ptrdiff_t>(_rows / 2));
+        }) };
+        const double soaTime{ best_ns(operations, _repetitions, [&] {
+            for (size_t i = 0; i < operations; ++i)
+                Layouts::insert(soaRows, _rows / 2, Layouts::make_row(i, 0));
+            for (size_t i = 0; i < operations; ++i)
+                soaRows.erase(_rows / 2);
+        }) };
+        print_result("insert + erase (op)", width, _rows, aosTime, soaTime);
+    }
+}
+
+int main(int _argc, char** _argv)
+{
+    const size_t maxRows{ _argc > 1 ? std::strtoull(_argv[1], nullptr, 10) : 10'000'000 };
+    const size_t repetitions{ _argc > 2 ? std::strtoull(_argv[2], nullptr, 10) : 5 };
+
+    std::printf("best of %zu runs, ns per row (per operation for insert + erase), ratio = SoA / AoS\n", repetitions);
+    std::printf("%-22s %-14s %12s %12s %12s %8s %12s\n", "operation", "row", "rows", "AoS", "SoA", "ratio", "SoA Mrows/s");
+    for (size_t rows = 1'000; rows <= maxRows; rows *= 10)
+    {
+        run<NarrowLayouts>(rows, repetitions);
+        run<WideLayouts>(rows, repetitions);
+    }
+    return 0;
+}
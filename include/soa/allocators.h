@@ -0,0 +1,349 @@
+#pragma once
+
+#include "soa.h"
+
+#include <memory_resource>
+
+namespace soa
+{
+    namespace detail
+    {
+        // Allocation unit of the arena chunks and pool blocks, so that std_allocator aligns them on a cache line
+        struct alignas(cache_line_size) cache_line
+        {
+            unsigned char bytes[cache_line_size];
+        };
+
+        constexpr size_t log2(size_t _value)
+        {
+            size_t result{};
+            while (_value > 1)
+            {
+                _value /= 2;
+                ++result;
+            }
+            return result;
+        }
+
+        inline size_t align_up(size_t _value, size_t _alignment)
+        {
+            return (_value + _alignment - 1) / _alignment * _alignment;
+        }
+    }
+
+    // Monotonic arena: allocations bump a cursor in large chunks, freeing does nothing, and reset() makes
+    // all the memory available again at once, keeping the chunks for the next allocations. All the containers
+    // allocating from an arena must be destroyed or cleared before it is reset, and it must outlive them.
+    // Not thread safe.
+    class arena
+    {
+    public:
+        explicit arena(size_t _chunkSize = size_t{ 1 } << 20)
+            : m_chunkSize{ detail::align_up(_chunkSize, detail::cache_line_size) }
+        {
+        }
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+
+        ~arena()
+        {
+            release();
+        }
+
+        void* allocate(size_t _size, size_t _alignment)
+        {
+            while (true)
+            {
+                if (m_current != nullptr)
+                {
+                    const uintptr_t base{ reinterpret_cast<uintptr_t>(m_current) };
+                    const size_t offset{ detail::align_up(base + m_offset, _alignment) - base };
+                    if (offset <= m_current->size && _size <= m_current->size - offset)
+                    {
+                        m_offset = offset + _size;
+                        return reinterpret_cast<unsigned char*>(m_current) + offset;
+                    }
+                }
+                next_chunk(_size, _alignment);
+            }
+        }
+
+        // Makes all the chunks available again, without releasing them
+        void reset()
+        {
+            m_current = m_first;
+            m_offset = sizeof(chunk);
+        }
+
+        // Releases all the chunks
+        void release()
+        {
+            while (m_first != nullptr)
+            {
+                chunk* next{ m_first->next };
+                std_allocator::free(reinterpret_cast<detail::cache_line*>(m_first));
+                m_first = next;
+            }
+            m_current = nullptr;
+            m_offset = 0;
+        }
+
+    private:
+        // Header of a chunk, at its beginning. size is the size of the whole chunk.
+        struct chunk
+        {
+            chunk* next;
+            size_t size;
+        };
+
+        // Moves to the next chunk, allocating a new one after the current one when the next one can't hold the allocation
+        void next_chunk(size_t _size, size_t _alignment)
+        {
+            const size_t required{ sizeof(chunk) + _alignment + _size };
+            chunk* next{ m_current != nullptr ? m_current->next : m_first };
+            if (next == nullptr || next->size < required)
+            {
+                const size_t size{ required > m_chunkSize ? detail::align_up(required, detail::cache_line_size) : m_chunkSize };
+                detail::cache_line* block{ std_allocator::allocate<detail::cache_line>(size / detail::cache_line_size) };
+                if (block == nullptr)
+                    throw bad_alloc{};
+
+                chunk* created{ ::new (static_cast<void*>(block)) chunk{ next, size } };
+                if (m_current != nullptr)
+                    m_current->next = created;
+                else
+                    m_first = created;
+                next = created;
+            }
+            m_current = next;
+            m_offset = sizeof(chunk);
+        }
+
+        size_t m_chunkSize{};
+        chunk* m_first{};
+        chunk* m_current{};
+        size_t m_offset{};
+    };
+
+    // Allocator of the containers, allocating from an arena. Copies allocate from the same arena and compare equal:
+    // moving a container to another one using the same arena transfers its memory.
+    class arena_allocator
+    {
+    public:
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+
+        arena_allocator(arena& _arena)
+            : m_arena{ &_arena }
+        {
+        }
+
+        template<typename T>
+        T* allocate(size_t _count)
+        {
+            return static_cast<T*>(m_arena->allocate(_count * sizeof(T), alignof(T)));
+        }
+
+        template<typename T>
+        void free(T* /*_ptr*/)
+        {
+        }
+
+        arena& resource() const
+        {
+            return *m_arena;
+        }
+
+        friend bool operator==(const arena_allocator& _lhs, const arena_allocator& _rhs)
+        {
+            return _lhs.m_arena == _rhs.m_arena;
+        }
+
+        friend bool operator!=(const arena_allocator& _lhs, const arena_allocator& _rhs)
+        {
+            return _lhs.m_arena != _rhs.m_arena;
+        }
+
+    private:
+        arena* m_arena;
+    };
+
+    // Pool of blocks in power of 2 size classes, from one cache line to max_block_size bytes. Freed blocks are kept
+    // in a free list per size class and reused by the next allocations of the same class, larger blocks are allocated
+    // and freed directly. The blocks being identified by their size, a pool needs sized deallocations.
+    // The pool must outlive the containers allocating from it. Not thread safe.
+    class pool
+    {
+    public:
+        static constexpr size_t min_block_size{ detail::cache_line_size };
+        static constexpr size_t max_block_size{ size_t{ 1 } << 24 };
+
+        pool() = default;
+
+        pool(const pool&) = delete;
+        pool& operator=(const pool&) = delete;
+
+        ~pool()
+        {
+            release();
+        }
+
+        template<typename T>
+        T* allocate(size_t _count)
+        {
+            const size_t size{ _count * sizeof(T) };
+            if (size > max_block_size || alignof(T) > detail::cache_line_size)
+                return std_allocator::allocate<T>(_count);
+
+            const size_t sizeClass{ size_class(size) };
+            node* block{ m_free[sizeClass] };
+            if (block != nullptr)
+            {
+                m_free[sizeClass] = block->next;
+                return reinterpret_cast<T*>(block);
+            }
+            return reinterpret_cast<T*>(std_allocator::allocate<detail::cache_line>(size_t{ 1 } << sizeClass));
+        }
+
+        template<typename T>
+        void free(T* _ptr, size_t _count)
+        {
+            const size_t size{ _count * sizeof(T) };
+            if (size > max_block_size || alignof(T) > detail::cache_line_size)
+            {
+                std_allocator::free(_ptr);
+                return;
+            }
+
+            const size_t sizeClass{ size_class(size) };
+            m_free[sizeClass] = ::new (static_cast<void*>(_ptr)) node{ m_free[sizeClass] };
+        }
+
+        // Releases the free blocks
+        void release()
+        {
+            for (node*& list : m_free)
+            {
+                while (list != nullptr)
+                {
+                    node* next{ list->next };
+                    std_allocator::free(reinterpret_cast<detail::cache_line*>(list));
+                    list = next;
+                }
+            }
+        }
+
+    private:
+        struct node
+        {
+            node* next;
+        };
+
+        // Size class of a block of _size bytes, as the log2 of its number of cache lines
+        static size_t size_class(size_t _size)
+        {
+            size_t sizeClass{};
+            while ((min_block_size << sizeClass) < _size)
+                ++sizeClass;
+            return sizeClass;
+        }
+
+        array<node*, detail::log2(max_block_size / min_block_size) + 1> m_free{};
+    };
+
+    // Allocator of the containers, allocating from a pool. Copies allocate from the same pool and compare equal.
+    class pool_allocator
+    {
+    public:
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+
+        pool_allocator(pool& _pool)
+            : m_pool{ &_pool }
+        {
+        }
+
+        template<typename T>
+        T* allocate(size_t _count)
+        {
+            return m_pool->allocate<T>(_count);
+        }
+
+        template<typename T>
+        void free(T* _ptr, size_t _count)
+        {
+            m_pool->free(_ptr, _count);
+        }
+
+        pool& resource() const
+        {
+            return *m_pool;
+        }
+
+        friend bool operator==(const pool_allocator& _lhs, const pool_allocator& _rhs)
+        {
+            return _lhs.m_pool == _rhs.m_pool;
+        }
+
+        friend bool operator!=(const pool_allocator& _lhs, const pool_allocator& _rhs)
+        {
+            return _lhs.m_pool != _rhs.m_pool;
+        }
+
+    private:
+        pool* m_pool;
+    };
+
+    // Allocator of the containers, allocating from a std::pmr::memory_resource (the default resource unless specified).
+    // Like std::pmr::polymorphic_allocator, it never propagates, and two allocators are equal when their resources are.
+    class pmr_allocator
+    {
+    public:
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+
+        pmr_allocator()
+            : m_resource{ std::pmr::get_default_resource() }
+        {
+        }
+
+        pmr_allocator(std::pmr::memory_resource* _resource)
+            : m_resource{ _resource }
+        {
+        }
+
+        template<typename T>
+        T* allocate(size_t _count)
+        {
+            return static_cast<T*>(m_resource->allocate(_count * sizeof(T), alignof(T)));
+        }
+
+        template<typename T>
+        void free(T* _ptr, size_t _count)
+        {
+            m_resource->deallocate(_ptr, _count * sizeof(T), alignof(T));
+        }
+
+        std::pmr::memory_resource* resource() const
+        {
+            return m_resource;
+        }
+
+        friend bool operator==(const pmr_allocator& _lhs, const pmr_allocator& _rhs)
+        {
+            return *_lhs.m_resource == *_rhs.m_resource;
+        }
+
+        friend bool operator!=(const pmr_allocator& _lhs, const pmr_allocator& _rhs)
+        {
+            return !(_lhs == _rhs);
+        }
+
+    private:
+        std::pmr::memory_resource* m_resource;
+    };
+}
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    // Structure of arrays keeping its rows sorted on one of its members, KeyMember, whose values are unique.
+    // Lookups are branchless binary searches reading only the key column: the other columns are only read
+    // for the rows which are found. Keys are compared with operator<, and lookups accept any type comparable with the key.
+    // Inserting a row shifts the next rows, insert_sorted merges a sorted batch of rows in a single pass.
+    // The key column can't be modified in place: the iterators and accessors give const access to it.
+    template <typename MembersDesc, MembersDesc KeyMember, typename Allocator, typename... Types>
+    class flat_map_base
+    {
+    public:
+        using rows_type = vector_base<MembersDesc, Allocator, Types...>;
+        using size_type = typename rows_type::size_type;
+
+        using value_list = typename rows_type::value_list;
+        using const_reference_list = typename rows_type::const_reference_list;
+
+        template<MembersDesc Member>
+        using member_type = typename rows_type::template member_type<Member>;
+
+        using key_type = member_type<KeyMember>;
+        using const_iterator = typename rows_type::const_iterator;
+
+        template<MembersDesc... Members>
+        using partial_iterator = typename rows_type::template partial_iterator<Members...>;
+
+        template<MembersDesc... Members>
+        using partial_const_iterator = typename rows_type::template partial_const_iterator<Members...>;
+
+        static constexpr size_type npos{ std::numeric_limits<size_type>::max() };
+
+        flat_map_base() = default;
+
+        explicit flat_map_base(Allocator _allocator)
+            : m_rows{ std::move(_allocator) }
+        {
+        }
+
+        size_type size() const
+        {
+            return m_rows.size();
+        }
+
+        size_type capacity() const
+        {
+            return m_rows.capacity();
+        }
+
+        bool empty() const
+        {
+            return m_rows.empty();
+        }
+
+        static constexpr size_type max_size()
+        {
+            return rows_type::max_size();
+        }
+
+        void reserve(size_type _capacity)
+        {
+            m_rows.reserve(_capacity);
+        }
+
+        void shrink_to_fit()
+        {
+            m_rows.shrink_to_fit();
+        }
+
+        void clear()
+        {
+            m_rows.clear();
+        }
+
+        // Index of the first row whose key is not less than _key
+        template<typename Key>
+        size_type lower_bound(const Key& _key) const
+        {
+            return search([&_key](const key_type& _rowKey) { return _rowKey < _key; });
+        }
+
+        // Index of the first row whose key is greater than _key
+        template<typename Key>
+        size_type upper_bound(const Key& _key) const
+        {
+            return search([&_key](const key_type& _rowKey) { return !(_key < _rowKey); });
+        }
+
+        // Rows [first, second) whose key is equal to _key: at most one row
+        template<typename Key>
+        std::pair<size_type, size_type> equal_range(const Key& _key) const
+        {
+            const size_type first{ lower_bound(_key) };
+            return { first, first < size() && !(_key < keys()[first]) ? first + 1 : first };
+        }
+
+        // Index of the row of the key, or npos
+        template<typename Key>
+        size_type find(const Key& _key) const
+        {
+            const size_type row{ lower_bound(_key) };
+            return row < size() && !(_key < keys()[row]) ? row : npos;
+        }
+
+        template<typename Key>
+        bool contains(const Key& _key) const
+        {
+            return find(_key) != npos;
+        }
+
+        template<typename Key>
+        size_type count(const Key& _key) const
+        {
+            return contains(_key) ? 1 : 0;
+        }
+
+        // Inserts a row at the position of its key, from the values of its members, and returns its index.
+        // When a row already has the key, nothing is inserted, and the index of this row is returned with false.
+        template<typename... Args>
+        std::pair<size_type, bool> insert(Args&&... _args)
+        {
+            static_assert(sizeof...(Args) == rows_type::members_count, "insert takes the values of all the members");
+
+            const auto& key{ get<static_cast<size_t>(KeyMember)>(forward_as_tuple(_args...)) };
+            const size_type row{ lower_bound(key) };
+            if (row < size() && !(key < keys()[row]))
+                return { row, false };
+
+            m_rows.insert(row, std::forward<Args>(_args)...);
+            return { row, true };
+        }
+
+        // Merges rows sorted on the key into the map, in a single pass over both, reading only their key columns to find the order.
+        // The rows whose key is already in the map, or in a previous row of the batch, are skipped. Returns the number of inserted rows.
+        size_type insert_sorted(const rows_type& _batch)
+        {
+            return merge(_batch);
+        }
+
+        size_type insert_sorted(rows_type&& _batch)
+        {
+            const size_type inserted{ merge(_batch) };
+            _batch.clear();
+            return inserted;
+        }
+
+        size_type erase(size_type _pos)
+        {
+            return m_rows.erase(_pos);
+        }
+
+        size_type erase(size_type _startPos, size_type _endPos)
+        {
+            return m_rows.erase(_startPos, _endPos);
+        }
+
+        // Erases the row of the key, returns the number of erased rows
+        template<typename Key>
+        size_type erase_key(const Key& _key)
+        {
+            const size_type row{ find(_key) };
+            if (row == npos)
+                return 0;
+
+            m_rows.erase(row);
+            return 1;
+        }
+
+        // The rows stay sorted
+        template<MembersDesc... Members, typename Predicate>
+        size_type erase_if(Predicate _predicate)
+        {
+            return m_rows.template erase_if<Members...>(_predicate);
+        }
+
+        // The key member is read only
+        template<MembersDesc Member>
+        auto& at(size_type _index)
+        {
+            if constexpr (Member == KeyMember)
+                return std::as_const(m_rows).template at<Member>(_index);
+            else
+                return m_rows.template at<Member>(_index);
+        }
+
+        template<MembersDesc Member>
+        const auto& at(size_type _index) const
+        {
+            return m_rows.template at<Member>(_index);
+        }
+
+        const_reference_list ref_at(size_type _index) const
+        {
+            return m_rows.ref_at(_index);
+        }
+
+        value_list value_at(size_type _index) const
+        {
+            return m_rows.value_at(_index);
+        }
+
+        const_iterator begin() const
+        {
+            return m_rows.begin();
+        }
+
+        const_iterator end() const
+        {
+            return m_rows.end();
+        }
+
+        const_iterator cbegin() const
+        {
+            return m_rows.cbegin();
+        }
+
+        const_iterator cend() const
+        {
+            return m_rows.cend();
+        }
+
+        // Only the other members can be modified through the iterators
+        template<MembersDesc... Members>
+        partial_iterator<Members...> begin()
+        {
+            static_assert(((Members != KeyMember) && ...), "The key member is read only");
+            return m_rows.template begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> end()
+        {
+            static_assert(((Members != KeyMember) && ...), "The key member is read only");
+            return m_rows.template end<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> begin() const
+        {
+            return m_rows.template begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> end() const
+        {
+            return m_rows.template end<Members...>();
+        }
+
+        template<MembersDesc Member>
+        span<member_type<Member>> column()
+        {
+            static_assert(Member != KeyMember, "The key member is read only");
+            return m_rows.template column<Member>();
+        }
+
+        template<MembersDesc Member>
+        span<const member_type<Member>> column() const
+        {
+            return m_rows.template column<Member>();
+        }
+
+        // Read only access to the rows, for the other algorithms of vector_base (slices, indexed iterators...)
+        const rows_type& rows() const
+        {
+            return m_rows;
+        }
+
+    private:
+        span<const key_type> keys() const
+        {
+            return m_rows.template column<KeyMember>();
+        }
+
+        // Index of the first row whose key doesn't satisfy _isBefore, the keys satisfying it being first.
+        // The range is halved without any branch on the comparisons, which are turned into conditional moves.
+        template<typename IsBefore>
+        size_type search(IsBefore _isBefore) const
+        {
+            const span<const key_type> rowKeys{ keys() };
+            size_type count{ rowKeys.size() };
+            if (count == 0)
+                return 0;
+
+            const key_type* first{ rowKeys.data() };
+            while (count > 1)
+            {
+                const size_type half{ count / 2 };
+                first = _isBefore(first[half]) ? first + half : first;
+                count -= half;
+            }
+            return static_cast<size_type>(first - rowKeys.data()) + (_isBefore(*first) ? 1 : 0);
+        }
+
+        // Appends the rows of both tables into a new one, in the order of their keys
+        template<typename Batch>
+        size_type merge(Batch& _batch)
+        {
+            constexpr bool moveBatch{ !std::is_const_v<Batch> };
+            if (_batch.empty())
+                return 0;
+
+            const span<const key_type> rowKeys{ keys() };
+            const span<const key_type> batchKeys{ std::as_const(_batch).template column<KeyMember>() };
+
+            rows_type merged{ m_rows.get_allocator() };
+            merged.reserve(size() + _batch.size());
+
+            size_type row{};
+            size_type batchRow{};
+            while (batchRow < batchKeys.size())
+            {
+                if (row < rowKeys.size() && !(batchKeys[batchRow] < rowKeys[row]))
+                    append_row<true>(merged, m_rows, row++);
+                else if (merged.empty() || merged.template column<KeyMember>()[merged.size() - 1] < batchKeys[batchRow])
+                    append_row<moveBatch>(merged, _batch, batchRow++);
+                else
+                    ++batchRow; // The key was already merged, from the map or the batch
+            }
+            while (row < rowKeys.size())
+                append_row<true>(merged, m_rows, row++);
+
+            const size_type inserted{ merged.size() - size() };
+            m_rows = std::move(merged);
+            return inserted;
+        }
+
+        template<bool Move, typename Rows>
+        static void append_row(rows_type& _to, Rows& _from, size_type _row)
+        {
+            if constexpr (Move)
+                apply([&_to](auto&... _members) { _to.push_back(std::move(_members)...); }, _from.ref_at(_row));
+            else
+                _to.push_back(_from.ref_at(_row));
+        }
+
+        rows_type m_rows;
+    };
+
+    template<typename MembersDesc, MembersDesc KeyMember, typename... Types>
+    using flat_map = soa::flat_map_base<MembersDesc, KeyMember, soa::std_allocator, Types...>;
+}
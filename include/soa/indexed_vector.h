@@ -0,0 +1,688 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    namespace detail
+    {
+        // Spreads the bits of a hash, so that the low bits used by a power of 2 table depend on all of them
+        inline size_t mix_hash(size_t _hash)
+        {
+            const uint64_t mixed{ static_cast<uint64_t>(_hash) * 0x9E3779B97F4A7C15ull };
+            return static_cast<size_t>(mixed ^ (mixed >> 32));
+        }
+
+        // Hash index of the rows of a table on a key, which doesn't store the keys: they are read from the table,
+        // through the _isKey(row) predicates of the lookups.
+        // Each distinct key has a bucket in an open addressing table with linear probing, holding the first row having this key
+        // and the full hash of the key, and the rows having the same key are linked by a next row column.
+        // Rows are stored plus one, 0 being the empty bucket and the end of the lists.
+        template<typename Allocator>
+        class hash_index
+        {
+        public:
+            static constexpr size_t npos{ std::numeric_limits<size_t>::max() };
+
+            hash_index() = default;
+
+            explicit hash_index(Allocator _allocator)
+                : m_buckets{ _allocator }
+                , m_next{ std::move(_allocator) }
+            {
+            }
+
+            hash_index(const hash_index&) = default;
+            hash_index& operator=(const hash_index&) = default;
+
+            hash_index(hash_index&& _other)
+                : m_buckets{ std::move(_other.m_buckets) }
+                , m_next{ std::move(_other.m_next) }
+                , m_keys{ std::exchange(_other.m_keys, 0) }
+            {
+            }
+
+            hash_index& operator=(hash_index&& _other)
+            {
+                if (this != &_other)
+                {
+                    m_buckets = std::move(_other.m_buckets);
+                    m_next = std::move(_other.m_next);
+                    m_keys = std::exchange(_other.m_keys, 0);
+                }
+                return *this;
+            }
+
+            // Makes room for _rows rows, so that adding rows up to this count doesn't allocate.
+            // The links grow geometrically, as reserve is called for each added row.
+            void reserve(size_t _rows)
+            {
+                if (_rows > m_next.capacity())
+                    m_next.reserve(_rows > 2 * m_next.capacity() ? _rows : 2 * m_next.capacity());
+                if (_rows * 2 > m_buckets.size())
+                {
+                    size_t count{ 16 };
+                    while (count < _rows * 2)
+                        count *= 2;
+                    rehash(count);
+                }
+            }
+
+            void clear()
+            {
+                std::fill_n(heads().data(), m_buckets.size(), size_t{});
+                m_next.clear();
+                m_keys = 0;
+            }
+
+            // Last linked row having the key, or npos
+            template<typename IsKey>
+            size_t find(size_t _hash, IsKey _isKey) const
+            {
+                const size_t bucket{ find_bucket(_hash, _isKey) };
+                return bucket != npos ? heads()[bucket] - 1 : npos;
+            }
+
+            // Calls _function(row) for each row having the key, from the last linked one
+            template<typename IsKey, typename Function>
+            void for_each(size_t _hash, IsKey _isKey, Function&& _function) const
+            {
+                for (size_t row = find(_hash, _isKey); row != npos; row = m_next.template column<link_members::Next>()[row] - 1)
+                    _function(row);
+            }
+
+            // Adds a row at the end, having the key. Doesn't allocate when reserve was called for the new number of rows.
+            template<typename IsKey>
+            void append(size_t _hash, IsKey _isKey)
+            {
+                m_next.push_back(size_t{});
+                link(m_next.size() - 1, _hash, _isKey);
+            }
+
+            // Adds a row at _row, having the key, the next rows being shifted
+            template<typename IsKey>
+            void insert(size_t _row, size_t _hash, IsKey _isKey)
+            {
+                offset_rows(_row, 1);
+                m_next.insert(_row, size_t{});
+                link(_row, _hash, _isKey);
+            }
+
+            // Removes the rows [_first, _last), which must have been unlinked, the next rows being shifted
+            void erase(size_t _first, size_t _last)
+            {
+                m_next.erase(_first, _last);
+                offset_rows(_last, -static_cast<ptrdiff_t>(_last - _first));
+            }
+
+            // Removes the last row, which must have been unlinked
+            void pop_back()
+            {
+                m_next.pop_back();
+            }
+
+            // Links a row to the other rows having the key. Doesn't allocate when reserve was called for the number of rows.
+            template<typename IsKey>
+            void link(size_t _row, size_t _hash, IsKey _isKey)
+            {
+                size_t bucket{ find_bucket(_hash, _isKey) };
+                if (bucket == npos)
+                {
+                    reserve_keys(m_keys + 1);
+                    bucket = _hash & mask();
+                    while (heads()[bucket] != 0)
+                        bucket = (bucket + 1) & mask();
+                    hashes()[bucket] = _hash;
+                    ++m_keys;
+                }
+                next()[_row] = heads()[bucket];
+                heads()[bucket] = _row + 1;
+            }
+
+            // Removes a row, having the key, from the rows having the key
+            template<typename IsKey>
+            void unlink(size_t _row, size_t _hash, IsKey _isKey)
+            {
+                const size_t bucket{ find_bucket(_hash, _isKey) };
+                size_t* entry{ &heads()[bucket] };
+                while (*entry != _row + 1)
+                    entry = &next()[*entry - 1];
+                *entry = next()[_row];
+
+                if (heads()[bucket] == 0)
+                {
+                    erase_bucket(bucket);
+                    --m_keys;
+                }
+            }
+
+            // Replaces a row, having the key, by _to in the rows having the key. _to must have been unlinked.
+            template<typename IsKey>
+            void relink(size_t _from, size_t _to, size_t _hash, IsKey _isKey)
+            {
+                size_t* entry{ &heads()[find_bucket(_hash, _isKey)] };
+                while (*entry != _from + 1)
+                    entry = &next()[*entry - 1];
+                *entry = _to + 1;
+                next()[_to] = next()[_from];
+            }
+
+        private:
+            enum class bucket_members
+            {
+                Head,
+                Hash,
+                Count
+            };
+
+            enum class link_members
+            {
+                Next,
+                Count
+            };
+
+            size_t mask() const
+            {
+                return m_buckets.size() - 1;
+            }
+
+            span<size_t> heads()
+            {
+                return m_buckets.template column<bucket_members::Head>();
+            }
+
+            span<const size_t> heads() const
+            {
+                return m_buckets.template column<bucket_members::Head>();
+            }
+
+            span<size_t> hashes()
+            {
+                return m_buckets.template column<bucket_members::Hash>();
+            }
+
+            span<const size_t> hashes() const
+            {
+                return m_buckets.template column<bucket_members::Hash>();
+            }
+
+            span<size_t> next()
+            {
+                return m_next.template column<link_members::Next>();
+            }
+
+            template<typename IsKey>
+            size_t find_bucket(size_t _hash, IsKey& _isKey) const
+            {
+                if (m_buckets.empty())
+                    return npos;
+
+                const span<const size_t> bucketHeads{ heads() };
+                const span<const size_t> bucketHashes{ hashes() };
+                for (size_t bucket = _hash & mask();; bucket = (bucket + 1) & mask())
+                {
+                    const size_t head{ bucketHeads[bucket] };
+                    if (head == 0)
+                        return npos;
+                    if (bucketHashes[bucket] == _hash && _isKey(head - 1))
+                        return bucket;
+                }
+            }
+
+            // Keeps the table at most half full
+            void reserve_keys(size_t _keys)
+            {
+                if (_keys * 2 > m_buckets.size())
+                    rehash(m_buckets.size() != 0 ? m_buckets.size() * 2 : 16);
+            }
+
+            void rehash(size_t _count)
+            {
+                buffer<size_t> keyHeads;
+                buffer<size_t> keyHashes;
+                keyHeads.reserve(m_keys);
+                keyHashes.reserve(m_keys);
+                for (size_t bucket = 0; bucket < m_buckets.size(); ++bucket)
+                {
+                    if (heads()[bucket] != 0)
+                    {
+                        keyHeads.push_back(heads()[bucket]);
+                        keyHashes.push_back(hashes()[bucket]);
+                    }
+                }
+
+                m_buckets.clear();
+                m_buckets.resize(_count);
+                m_buckets.shrink_to_fit();
+                for (size_t key = 0; key < keyHeads.size(); ++key)
+                {
+                    size_t bucket{ keyHashes[key] & mask() };
+                    while (heads()[bucket] != 0)
+                        bucket = (bucket + 1) & mask();
+                    heads()[bucket] = keyHeads[key];
+                    hashes()[bucket] = keyHashes[key];
+                }
+            }
+
+            // Backward shift deletion: the next buckets of the probe sequence are moved back, so that no tombstone is needed
+            void erase_bucket(size_t _bucket)
+            {
+                for (size_t bucket = (_bucket + 1) & mask(); heads()[bucket] != 0; bucket = (bucket + 1) & mask())
+                {
+                    const size_t home{ hashes()[bucket] & mask() };
+                    if (((bucket - home) & mask()) >= ((bucket - _bucket) & mask()))
+                    {
+                        heads()[_bucket] = heads()[bucket];
+                        hashes()[_bucket] = hashes()[bucket];
+                        _bucket = bucket;
+                    }
+                }
+                heads()[_bucket] = 0;
+            }
+
+            // Adds _offset to the rows from _first
+            void offset_rows(size_t _first, ptrdiff_t _offset)
+            {
+                const auto shift = [_first, _offset](size_t& _entry) {
+                    if (_entry > _first)
+                        _entry = static_cast<size_t>(static_cast<ptrdiff_t>(_entry) + _offset);
+                };
+                for (size_t& head : heads())
+                    shift(head);
+                for (size_t& entry : next())
+                    shift(entry);
+            }
+
+            vector_base<bucket_members, Allocator, size_t, size_t> m_buckets;
+            vector_base<link_members, Allocator, size_t> m_next;
+            size_t m_keys{};
+        };
+    }
+
+    // Structure of arrays maintaining a hash index on one of its members, KeyMember: find<KeyMember>(key) returns the index
+    // of a row having the key in constant time. The index is updated by all the operations changing the rows, and follows
+    // their moves. Keys can be duplicated, the rows having the same key are linked together.
+    // The key column can't be modified in place: the iterators and accessors give const access to it, use assign_key.
+    template <typename MembersDesc, MembersDesc KeyMember, typename Allocator, typename... Types>
+    class indexed_vector_base
+    {
+    public:
+        using rows_type = vector_base<MembersDesc, Allocator, Types...>;
+        using size_type = typename rows_type::size_type;
+
+        using value_list = typename rows_type::value_list;
+        using const_reference_list = typename rows_type::const_reference_list;
+
+        template<MembersDesc Member>
+        using member_type = typename rows_type::template member_type<Member>;
+
+        using key_type = member_type<KeyMember>;
+        using const_iterator = typename rows_type::const_iterator;
+
+        template<MembersDesc... Members>
+        using partial_iterator = typename rows_type::template partial_iterator<Members...>;
+
+        template<MembersDesc... Members>
+        using partial_const_iterator = typename rows_type::template partial_const_iterator<Members...>;
+
+        static constexpr size_type npos{ std::numeric_limits<size_type>::max() };
+
+        indexed_vector_base() = default;
+
+        explicit indexed_vector_base(Allocator _allocator)
+            : m_rows{ _allocator }
+            , m_index{ std::move(_allocator) }
+        {
+        }
+
+        size_type size() const
+        {
+            return m_rows.size();
+        }
+
+        size_type capacity() const
+        {
+            return m_rows.capacity();
+        }
+
+        bool empty() const
+        {
+            return m_rows.empty();
+        }
+
+        static constexpr size_type max_size()
+        {
+            return rows_type::max_size();
+        }
+
+        void reserve(size_type _capacity)
+        {
+            m_rows.reserve(_capacity);
+            m_index.reserve(_capacity);
+        }
+
+        void shrink_to_fit()
+        {
+            m_rows.shrink_to_fit();
+        }
+
+        void clear()
+        {
+            m_rows.clear();
+            m_index.clear();
+        }
+
+        template<typename... Args>
+        void push_back(Args&&... _args)
+        {
+            m_index.reserve(size() + 1);
+            m_rows.push_back(std::forward<Args>(_args)...);
+            const key_type& key{ key_at(size() - 1) };
+            m_index.append(hash(key), is_key(key));
+        }
+
+        void pop_back()
+        {
+            const key_type& key{ key_at(size() - 1) };
+            m_index.unlink(size() - 1, hash(key), is_key(key));
+            m_index.pop_back();
+            m_rows.pop_back();
+        }
+
+        void resize(size_type _size)
+        {
+            if (_size <= size())
+                shrink_rows(_size);
+            else
+                grow_rows(_size, [&] { m_rows.resize(_size); });
+        }
+
+        template<typename... Args>
+        void resize(size_type _size, Args&&... _args)
+        {
+            if (_size <= size())
+                shrink_rows(_size);
+            else
+                grow_rows(_size, [&] { m_rows.resize(_size, std::forward<Args>(_args)...); });
+        }
+
+        template<typename... Args>
+        void insert(size_type _pos, Args&&... _args)
+        {
+            m_index.reserve(size() + 1);
+            m_rows.insert(_pos, std::forward<Args>(_args)...);
+            const key_type& key{ key_at(_pos) };
+            m_index.insert(_pos, hash(key), is_key(key));
+        }
+
+        size_type erase(size_type _pos)
+        {
+            return erase(_pos, _pos + 1);
+        }
+
+        // The rows are unlinked from the last one, the rows having the same key being linked from the last inserted one
+        size_type erase(size_type _startPos, size_type _endPos)
+        {
+            for (size_type row = _endPos; row-- > _startPos;)
+            {
+                const key_type& key{ key_at(row) };
+                m_index.unlink(row, hash(key), is_key(key));
+            }
+            m_index.erase(_startPos, _endPos);
+            return m_rows.erase(_startPos, _endPos);
+        }
+
+        // Moves the last row into the erased one: the index is updated in constant time
+        size_type erase_unordered(size_type _pos)
+        {
+            const size_type last{ size() - 1 };
+            const key_type& key{ key_at(_pos) };
+            m_index.unlink(_pos, hash(key), is_key(key));
+            if (_pos != last)
+            {
+                const key_type& lastKey{ key_at(last) };
+                m_index.relink(last, _pos, hash(lastKey), is_key(lastKey));
+            }
+            m_index.pop_back();
+            return m_rows.erase_unordered(_pos);
+        }
+
+        // The rows are erased in a single pass, and the index is rebuilt
+        template<MembersDesc... Members, typename Predicate>
+        size_type erase_if(Predicate _predicate)
+        {
+            const size_type erased{ m_rows.template erase_if<Members...>(_predicate) };
+            rebuild_index();
+            return erased;
+        }
+
+        template<MembersDesc... Members, typename Predicate>
+        size_type erase_if_unordered(Predicate _predicate)
+        {
+            const size_type erased{ m_rows.template erase_if_unordered<Members...>(_predicate) };
+            rebuild_index();
+            return erased;
+        }
+
+        // Index of a row having the key, or npos. When several rows have the key, returns the last inserted one.
+        template<MembersDesc Member>
+        size_type find(const key_type& _key) const
+        {
+            static_assert(Member == KeyMember, "Only the key member is indexed");
+            return m_index.find(hash(_key), is_key(_key));
+        }
+
+        template<MembersDesc Member>
+        bool contains(const key_type& _key) const
+        {
+            return find<Member>(_key) != npos;
+        }
+
+        // Number of rows having the key
+        template<MembersDesc Member>
+        size_type count(const key_type& _key) const
+        {
+            static_assert(Member == KeyMember, "Only the key member is indexed");
+            size_type rows{};
+            m_index.for_each(hash(_key), is_key(_key), [&rows](size_type) { ++rows; });
+            return rows;
+        }
+
+        // Calls _function(index) for each row having the key
+        template<MembersDesc Member, typename Function>
+        void for_each_match(const key_type& _key, Function&& _function) const
+        {
+            static_assert(Member == KeyMember, "Only the key member is indexed");
+            m_index.for_each(hash(_key), is_key(_key), std::forward<Function>(_function));
+        }
+
+        // Changes the key of a row, updating the index
+        template<typename Key>
+        void assign_key(size_type _index, Key&& _key)
+        {
+            key_type& key{ m_rows.template at<KeyMember>(_index) };
+            m_index.reserve(size());
+            m_index.unlink(_index, hash(key), is_key(key));
+            try
+            {
+                key = std::forward<Key>(_key);
+            }
+            catch (...)
+            {
+                m_index.link(_index, hash(key), is_key(key));
+                throw;
+            }
+            m_index.link(_index, hash(key), is_key(key));
+        }
+
+        // The key member is read only
+        template<MembersDesc Member>
+        auto& at(size_type _index)
+        {
+            if constexpr (Member == KeyMember)
+                return std::as_const(m_rows).template at<Member>(_index);
+            else
+                return m_rows.template at<Member>(_index);
+        }
+
+        template<MembersDesc Member>
+        const auto& at(size_type _index) const
+        {
+            return m_rows.template at<Member>(_index);
+        }
+
+        const_reference_list ref_at(size_type _index) const
+        {
+            return m_rows.ref_at(_index);
+        }
+
+        value_list value_at(size_type _index) const
+        {
+            return m_rows.value_at(_index);
+        }
+
+        const_iterator begin() const
+        {
+            return m_rows.begin();
+        }
+
+        const_iterator end() const
+        {
+            return m_rows.end();
+        }
+
+        const_iterator cbegin() const
+        {
+            return m_rows.cbegin();
+        }
+
+        const_iterator cend() const
+        {
+            return m_rows.cend();
+        }
+
+        // Only the other members can be modified through the iterators
+        template<MembersDesc... Members>
+        partial_iterator<Members...> begin()
+        {
+            static_assert(((Members != KeyMember) && ...), "The key member is read only, see assign_key");
+            return m_rows.template begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> end()
+        {
+            static_assert(((Members != KeyMember) && ...), "The key member is read only, see assign_key");
+            return m_rows.template end<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> begin() const
+        {
+            return m_rows.template begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> end() const
+        {
+            return m_rows.template end<Members...>();
+        }
+
+        template<MembersDesc Member>
+        span<member_type<Member>> column()
+        {
+            static_assert(Member != KeyMember, "The key member is read only, see assign_key");
+            return m_rows.template column<Member>();
+        }
+
+        template<MembersDesc Member>
+        span<const member_type<Member>> column() const
+        {
+            return m_rows.template column<Member>();
+        }
+
+        // The rows are sorted as by vector_base, and the index is rebuilt
+        template<MembersDesc... Members>
+        void sort()
+        {
+            m_rows.template sort<Members...>();
+            rebuild_index();
+        }
+
+        template<MembersDesc... Members, typename Compare>
+        void sort_by(Compare _compare)
+        {
+            m_rows.template sort_by<Members...>(_compare);
+            rebuild_index();
+        }
+
+        // Read only access to the rows, for the other algorithms of vector_base (slices, indexed iterators...)
+        const rows_type& rows() const
+        {
+            return m_rows;
+        }
+
+    private:
+        static size_t hash(const key_type& _key)
+        {
+            return detail::mix_hash(std::hash<key_type>{}(_key));
+        }
+
+        const key_type& key_at(size_type _index) const
+        {
+            return m_rows.template at<KeyMember>(_index);
+        }
+
+        auto is_key(const key_type& _key) const
+        {
+            return [this, &_key](size_type _row) { return key_at(_row) == _key; };
+        }
+
+        void shrink_rows(size_type _size)
+        {
+            if (_size == 0)
+            {
+                clear();
+                return;
+            }
+
+            for (size_type row = size(); row-- > _size;)
+            {
+                const key_type& key{ key_at(row) };
+                m_index.unlink(row, hash(key), is_key(key));
+                m_index.pop_back();
+            }
+            m_rows.resize(_size);
+        }
+
+        template<typename Resize>
+        void grow_rows(size_type _size, Resize&& _resize)
+        {
+            m_index.reserve(_size);
+            const size_type first{ size() };
+            _resize();
+            for (size_type row = first; row < _size; ++row)
+            {
+                const key_type& key{ key_at(row) };
+                m_index.append(hash(key), is_key(key));
+            }
+        }
+
+        void rebuild_index()
+        {
+            m_index.clear();
+            m_index.reserve(size());
+            for (size_type row = 0; row < size(); ++row)
+            {
+                const key_type& key{ key_at(row) };
+                m_index.append(hash(key), is_key(key));
+            }
+        }
+
+        rows_type m_rows;
+        detail::hash_index<Allocator> m_index;
+    };
+
+    template<typename MembersDesc, MembersDesc KeyMember, typename... Types>
+    using indexed_vector = soa::indexed_vector_base<MembersDesc, KeyMember, soa::std_allocator, Types...>;
+}
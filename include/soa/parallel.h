@@ -0,0 +1,269 @@
+#pragma once
+
+#include "soa.h"
+
+#include <condition_variable>
+#include <mutex>
+
+namespace soa
+{
+    // Fixed set of threads running bulk jobs: bulk_execute(tasks, task) calls task(i) for each i in [0, tasks),
+    // on the threads of the pool and the calling one, and returns when all the tasks are done.
+    // The tasks are split in one contiguous range per thread, each thread taking the tasks from the front of its range,
+    // then stealing the back half of the range of another thread once its own range is empty: threads finishing early
+    // take over the work of the slower ones, while neighbouring tasks mostly run on the same thread.
+    // A job runs at a time: the jobs submitted by several threads are run one after the other, and a job submitted
+    // from a task runs on the thread of the task.
+    class thread_pool
+    {
+    public:
+        // threads counts the calling thread: a pool of N threads starts N - 1 threads. 0 uses the hardware threads.
+        explicit thread_pool(size_t _threads = 0)
+        {
+            const size_t threads{ _threads != 0 ? _threads : detail::policy_threads(parallel_policy{}) };
+            m_ranges.reset(new task_range[threads]);
+            m_threads = threads;
+            m_workers.reserve(threads - 1);
+            try
+            {
+                for (size_t worker = 1; worker < threads; ++worker)
+                    m_workers.emplace_back([this, worker] { work_loop(worker); });
+            }
+            catch (...)
+            {
+                stop();
+                throw;
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool()
+        {
+            stop();
+        }
+
+        // Number of threads running a job, including the calling one
+        size_t size() const
+        {
+            return m_threads;
+        }
+
+        // The first exception thrown by a task is rethrown once all the tasks are done
+        template<typename Task>
+        void bulk_execute(size_t _tasks, Task&& _task)
+        {
+            if (_tasks == 0)
+                return;
+
+            if (_tasks == 1 || m_threads == 1 || in_task())
+            {
+                std::exception_ptr error;
+                for (size_t task = 0; task < _tasks; ++task)
+                {
+                    try
+                    {
+                        _task(task);
+                    }
+                    catch (...)
+                    {
+                        if (!error)
+                            error = std::current_exception();
+                    }
+                }
+                if (error)
+                    std::rethrow_exception(error);
+                return;
+            }
+
+            std::lock_guard<std::mutex> submit{ m_submitMutex };
+            using task_type = std::remove_reference_t<Task>;
+            job current{ [](void* _context, size_t _index) { (*static_cast<task_type*>(_context))(_index); }, const_cast<void*>(static_cast<const void*>(&_task)) };
+            for (size_t thread = 0; thread < m_threads; ++thread)
+            {
+                m_ranges[thread].begin = _tasks * thread / m_threads;
+                m_ranges[thread].end = _tasks * (thread + 1) / m_threads;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                m_job = &current;
+                ++m_generation;
+            }
+            m_wake.notify_all();
+
+            run(current, 0);
+
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                m_job = nullptr;
+                m_idle.wait(lock, [this] { return m_busy == 0; });
+            }
+
+            if (current.error)
+                std::rethrow_exception(current.error);
+        }
+
+        // Pool used by the parallel algorithms when no executor is given, with a thread per hardware thread
+        static thread_pool& shared()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+
+    private:
+        struct job
+        {
+            void (*call)(void*, size_t);
+            void* context;
+            std::exception_ptr error{};
+            std::atomic<bool> failed{};
+        };
+
+        // Tasks [begin, end) left to a thread, on its own cache line
+        struct alignas(detail::cache_line_size) task_range
+        {
+            std::mutex mutex;
+            size_t begin{};
+            size_t end{};
+        };
+
+        static bool& in_task()
+        {
+            thread_local bool inTask{};
+            return inTask;
+        }
+
+        void work_loop(size_t _thread)
+        {
+            size_t seen{};
+            std::unique_lock<std::mutex> lock{ m_mutex };
+            while (true)
+            {
+                m_wake.wait(lock, [this, seen] { return m_stop || (m_job != nullptr && m_generation != seen); });
+                if (m_stop)
+                    return;
+
+                seen = m_generation;
+                job& current{ *m_job };
+                ++m_busy;
+                lock.unlock();
+
+                run(current, _thread);
+
+                lock.lock();
+                if (--m_busy == 0)
+                    m_idle.notify_all();
+            }
+        }
+
+        void run(job& _job, size_t _thread)
+        {
+            in_task() = true;
+            size_t task{};
+            while (take(_thread, task) || steal(_thread, task))
+            {
+                try
+                {
+                    _job.call(_job.context, task);
+                }
+                catch (...)
+                {
+                    if (!_job.failed.exchange(true))
+                        _job.error = std::current_exception();
+                }
+            }
+            in_task() = false;
+        }
+
+        bool take(size_t _thread, size_t& _task)
+        {
+            task_range& range{ m_ranges[_thread] };
+            std::lock_guard<std::mutex> lock{ range.mutex };
+            if (range.begin == range.end)
+                return false;
+
+            _task = range.begin++;
+            return true;
+        }
+
+        // Moves the back half of the first non empty range of the other threads into the range of this thread, and takes its first task
+        bool steal(size_t _thread, size_t& _task)
+        {
+            for (size_t offset = 1; offset < m_threads; ++offset)
+            {
+                task_range& victim{ m_ranges[(_thread + offset) % m_threads] };
+                size_t first{};
+                size_t last{};
+                {
+                    std::lock_guard<std::mutex> lock{ victim.mutex };
+                    if (victim.begin == victim.end)
+                        continue;
+
+                    first = victim.begin + (victim.end - victim.begin) / 2;
+                    last = victim.end;
+                    victim.end = first;
+                }
+
+                task_range& range{ m_ranges[_thread] };
+                std::lock_guard<std::mutex> lock{ range.mutex };
+                range.begin = first + 1;
+                range.end = last;
+                _task = first;
+                return true;
+            }
+            return false;
+        }
+
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                m_stop = true;
+            }
+            m_wake.notify_all();
+            for (std::thread& worker : m_workers)
+                worker.join();
+        }
+
+        std::unique_ptr<task_range[]> m_ranges;
+        size_t m_threads{};
+        buffer<std::thread> m_workers;
+
+        std::mutex m_submitMutex;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        job* m_job{};
+        size_t m_generation{};
+        size_t m_busy{};
+        bool m_stop{};
+    };
+
+    // Default number of rows of the chunks of parallel_for_each
+    constexpr size_t parallel_grain{ 16384 };
+
+    // Splits the rows of a table in chunks of _grain rows, and calls _function(first, last) on each chunk, from several threads,
+    // first and last being the partial iterators of the given members (the iterators of all the members when none is given).
+    // The chunks are run by _executor, any type providing bulk_execute(tasks, task) as thread_pool does, by default the shared pool.
+    // The function may modify the members of the rows of its chunk, but not add or remove rows.
+    template<auto... Members, typename Table, typename Function, typename Executor = thread_pool>
+    void parallel_for_each(Table& _table, Function _function, size_t _grain = parallel_grain, Executor& _executor = thread_pool::shared())
+    {
+        const auto first{ [&_table] {
+            if constexpr (sizeof...(Members) == 0)
+                return _table.begin();
+            else
+                return _table.template begin<Members...>();
+        }() };
+
+        const size_t rows{ static_cast<size_t>(_table.size()) };
+        const size_t grain{ _grain != 0 ? _grain : 1 };
+        _executor.bulk_execute((rows + grain - 1) / grain, [&first, &_function, rows, grain](size_t _chunk) {
+            const size_t begin{ _chunk * grain };
+            const size_t end{ rows - begin < grain ? rows : begin + grain };
+            _function(first + static_cast<ptrdiff_t>(begin), first + static_cast<ptrdiff_t>(end));
+        });
+    }
+}
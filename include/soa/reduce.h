@@ -0,0 +1,306 @@
+#pragma once
+
+#include "soa.h"
+
+// Kernels are compiled for several instruction sets, selected at runtime, with GCC and Clang on x86
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOA_ISA_DISPATCH
+#if defined(__clang__)
+#define SOA_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq")))
+#else
+// GCC uses 256 bits vectors with AVX-512 unless told otherwise
+#define SOA_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,prefer-vector-width=512")))
+#endif
+// The kernels, and the predicates they call, must be inlined into the functions compiled for each instruction set:
+// otherwise these functions only call the generic kernel
+#define SOA_KERNEL __attribute__((always_inline))
+#define SOA_KERNEL_TARGET __attribute__((flatten))
+#else
+#define SOA_KERNEL
+#define SOA_KERNEL_TARGET
+#endif
+
+namespace soa
+{
+    namespace detail
+    {
+        // Independent accumulators of the kernels: each one is a lane of the vector registers,
+        // so that the loops are vectorized without reordering the operations
+        constexpr size_t reduce_lanes{ 16 };
+
+        template<typename T>
+        using sum_type = std::conditional_t<std::is_floating_point_v<T>, T, std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+        template<typename T>
+        struct sum_kernel
+        {
+            SOA_KERNEL sum_type<T> operator()(const T* _values, size_t _count) const
+            {
+                sum_type<T> lanes[reduce_lanes]{};
+                size_t i{};
+                for (; i + reduce_lanes <= _count; i += reduce_lanes)
+                {
+                    for (size_t lane = 0; lane < reduce_lanes; ++lane)
+                        lanes[lane] += _values[i + lane];
+                }
+                for (; i < _count; ++i)
+                    lanes[i % reduce_lanes] += _values[i];
+
+                sum_type<T> sum{};
+                for (sum_type<T> lane : lanes)
+                    sum += lane;
+                return sum;
+            }
+        };
+
+        template<typename T>
+        struct minmax_kernel
+        {
+            SOA_KERNEL std::pair<T, T> operator()(const T* _values, size_t _count) const
+            {
+                T minLanes[reduce_lanes];
+                T maxLanes[reduce_lanes];
+                std::fill_n(minLanes, reduce_lanes, std::numeric_limits<T>::max());
+                std::fill_n(maxLanes, reduce_lanes, std::numeric_limits<T>::lowest());
+
+                size_t i{};
+                for (; i + reduce_lanes <= _count; i += reduce_lanes)
+                {
+                    for (size_t lane = 0; lane < reduce_lanes; ++lane)
+                    {
+                        const T value{ _values[i + lane] };
+                        minLanes[lane] = value < minLanes[lane] ? value : minLanes[lane];
+                        maxLanes[lane] = maxLanes[lane] < value ? value : maxLanes[lane];
+                    }
+                }
+                for (; i < _count; ++i)
+                {
+                    minLanes[0] = _values[i] < minLanes[0] ? _values[i] : minLanes[0];
+                    maxLanes[0] = maxLanes[0] < _values[i] ? _values[i] : maxLanes[0];
+                }
+                return combine(minLanes, maxLanes);
+            }
+
+            SOA_KERNEL static std::pair<T, T> combine(const T* _minLanes, const T* _maxLanes)
+            {
+                std::pair<T, T> result{ _minLanes[0], _maxLanes[0] };
+                for (size_t lane = 1; lane < reduce_lanes; ++lane)
+                {
+                    result.first = _minLanes[lane] < result.first ? _minLanes[lane] : result.first;
+                    result.second = result.second < _maxLanes[lane] ? _maxLanes[lane] : result.second;
+                }
+                return result;
+            }
+        };
+
+        template<typename T, typename Predicate>
+        struct count_kernel
+        {
+            SOA_KERNEL size_t operator()(const T* _values, size_t _count) const
+            {
+                size_t lanes[reduce_lanes]{};
+                size_t i{};
+                for (; i + reduce_lanes <= _count; i += reduce_lanes)
+                {
+                    for (size_t lane = 0; lane < reduce_lanes; ++lane)
+                        lanes[lane] += predicate(_values[i + lane]) ? 1 : 0;
+                }
+                for (; i < _count; ++i)
+                    lanes[0] += predicate(_values[i]) ? 1 : 0;
+
+                size_t count{};
+                for (size_t lane : lanes)
+                    count += lane;
+                return count;
+            }
+
+            Predicate predicate;
+        };
+
+        // The values out of [min, max) are counted in an extra bin, dropped at the end, so that the loop has no branch
+        template<typename T>
+        struct histogram_kernel
+        {
+            SOA_KERNEL buffer<size_t> operator()(const T* _values, size_t _count) const
+            {
+                buffer<size_t> counts(bins + 1);
+                const double scale{ static_cast<double>(bins) / (static_cast<double>(max) - static_cast<double>(min)) };
+                for (size_t i = 0; i < _count; ++i)
+                {
+                    const T value{ _values[i] };
+                    const bool inRange{ ((value >= min) & (value < max)) != 0 };
+                    const size_t bin{ inRange ? static_cast<size_t>((static_cast<double>(value) - static_cast<double>(min)) * scale) : bins };
+                    ++counts[bin < bins ? bin : (inRange ? bins - 1 : bins)];
+                }
+                counts.pop_back();
+                return counts;
+            }
+
+            T min;
+            T max;
+            size_t bins;
+        };
+
+        enum class instruction_set
+        {
+            generic,
+            avx2,
+            avx512
+        };
+
+        inline instruction_set detect_instruction_set()
+        {
+#ifdef SOA_ISA_DISPATCH
+            static const instruction_set detected{ [] {
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq"))
+                    return instruction_set::avx512;
+                if (__builtin_cpu_supports("avx2"))
+                    return instruction_set::avx2;
+                return instruction_set::generic;
+            }() };
+            return detected;
+#else
+            return instruction_set::generic;
+#endif
+        }
+
+        // The kernels are inlined into these functions, and compiled for their instruction set
+        template<typename Kernel, typename T>
+        auto run_generic(const Kernel& _kernel, const T* _values, size_t _count)
+        {
+            return _kernel(_values, _count);
+        }
+
+#ifdef SOA_ISA_DISPATCH
+        template<typename Kernel, typename T>
+        __attribute__((target("avx2"))) SOA_KERNEL_TARGET auto run_avx2(const Kernel& _kernel, const T* _values, size_t _count)
+        {
+            return _kernel(_values, _count);
+        }
+
+        template<typename Kernel, typename T>
+        SOA_TARGET_AVX512 SOA_KERNEL_TARGET auto run_avx512(const Kernel& _kernel, const T* _values, size_t _count)
+        {
+            return _kernel(_values, _count);
+        }
+#endif
+
+        // Runs a kernel compiled for the best instruction set of the processor
+        template<typename Kernel, typename T>
+        auto run_kernel(const Kernel& _kernel, const T* _values, size_t _count)
+        {
+#ifdef SOA_ISA_DISPATCH
+            switch (detect_instruction_set())
+            {
+            case instruction_set::avx512:
+                return run_avx512(_kernel, _values, _count);
+            case instruction_set::avx2:
+                return run_avx2(_kernel, _values, _count);
+            default:
+                break;
+            }
+#endif
+            return run_generic(_kernel, _values, _count);
+        }
+
+        template<typename Kernel, typename T, typename Combine>
+        auto reduce_column(const sequential_policy&, const Kernel& _kernel, const T* _values, size_t _count, Combine)
+        {
+            return run_kernel(_kernel, _values, _count);
+        }
+
+        // Splits the rows in contiguous parts, one per thread, and combines the results of the parts in their order
+        template<typename Kernel, typename T, typename Combine>
+        auto reduce_column(const parallel_policy& _policy, const Kernel& _kernel, const T* _values, size_t _count, Combine _combine)
+        {
+            const size_t maxParts{ _count / (_policy.min_rows != 0 ? _policy.min_rows : 1) };
+            const size_t threads{ policy_threads(_policy) };
+            const size_t parts{ threads < maxParts ? threads : maxParts };
+            if (parts <= 1)
+                return run_kernel(_kernel, _values, _count);
+
+            using result_type = decltype(run_kernel(_kernel, _values, _count));
+            buffer<result_type> results(parts);
+            const auto part_begin = [_count, parts](size_t _part) { return _count / parts * _part + (_part < _count % parts ? _part : _count % parts); };
+            run_parallel(parts, parts, [&](size_t _part) {
+                const size_t first{ part_begin(_part) };
+                results[_part] = run_kernel(_kernel, _values + first, part_begin(_part + 1) - first);
+            });
+
+            result_type result{ std::move(results[0]) };
+            for (size_t part = 1; part < parts; ++part)
+                result = _combine(std::move(result), std::move(results[part]));
+            return result;
+        }
+
+        template<auto Member, typename Table>
+        auto reduced_column(const Table& _table)
+        {
+            const auto column{ _table.template column<Member>() };
+            static_assert(std::is_arithmetic_v<typename decltype(column)::value_type>, "Reductions apply to arithmetic members");
+            return column;
+        }
+    }
+
+    // Sum of an arithmetic member of all the rows. Integers are summed as 64 bits integers, floating point values in their type,
+    // in several interleaved partial sums: the result may differ from a sequential sum by rounding.
+    template<auto Member, typename Table, typename Policy = sequential_policy>
+    auto sum(const Table& _table, const Policy& _policy = {})
+    {
+        const auto column{ detail::reduced_column<Member>(_table) };
+        using value_type = typename decltype(column)::value_type;
+        return detail::reduce_column(_policy, detail::sum_kernel<value_type>{}, column.data(), column.size(), std::plus<>{});
+    }
+
+    // Smallest and largest values of an arithmetic member. Without any row, returns the largest value of the type
+    // as the minimum, and the lowest one as the maximum.
+    template<auto Member, typename Table, typename Policy = sequential_policy>
+    auto minmax(const Table& _table, const Policy& _policy = {})
+    {
+        const auto column{ detail::reduced_column<Member>(_table) };
+        using value_type = typename decltype(column)::value_type;
+        return detail::reduce_column(_policy, detail::minmax_kernel<value_type>{}, column.data(), column.size(), [](std::pair<value_type, value_type> _lhs, std::pair<value_type, value_type> _rhs) {
+            return std::pair<value_type, value_type>{ _rhs.first < _lhs.first ? _rhs.first : _lhs.first, _lhs.second < _rhs.second ? _rhs.second : _lhs.second };
+        });
+    }
+
+    template<auto Member, typename Table, typename Policy = sequential_policy>
+    auto min(const Table& _table, const Policy& _policy = {})
+    {
+        return minmax<Member>(_table, _policy).first;
+    }
+
+    template<auto Member, typename Table, typename Policy = sequential_policy>
+    auto max(const Table& _table, const Policy& _policy = {})
+    {
+        return minmax<Member>(_table, _policy).second;
+    }
+
+    // Number of rows whose member satisfies the predicate, which should be free of branches to be vectorized
+    template<auto Member, typename Table, typename Predicate, typename Policy = sequential_policy>
+    size_t count_if(const Table& _table, Predicate _predicate, const Policy& _policy = {})
+    {
+        const auto column{ detail::reduced_column<Member>(_table) };
+        using value_type = typename decltype(column)::value_type;
+        return detail::reduce_column(_policy, detail::count_kernel<value_type, Predicate>{ _predicate }, column.data(), column.size(), std::plus<>{});
+    }
+
+    // Number of rows whose member is in each of _bins bins of the same width, dividing [_min, _max).
+    // The values out of the range are not counted.
+    template<auto Member, typename Table, typename T, typename Policy = sequential_policy>
+    buffer<size_t> histogram(const Table& _table, T _min, T _max, size_t _bins, const Policy& _policy = {})
+    {
+        const auto column{ detail::reduced_column<Member>(_table) };
+        using value_type = typename decltype(column)::value_type;
+        if (_bins == 0 || !(_min < _max))
+            throw std::invalid_argument{ "soa::histogram: empty range" };
+
+        const detail::histogram_kernel<value_type> kernel{ static_cast<value_type>(_min), static_cast<value_type>(_max), _bins };
+        return detail::reduce_column(_policy, kernel, column.data(), column.size(), [](buffer<size_t> _lhs, const buffer<size_t>& _rhs) {
+            for (size_t bin = 0; bin < _lhs.size(); ++bin)
+                _lhs[bin] += _rhs[bin];
+            return _lhs;
+        });
+    }
+}
@@ -0,0 +1,593 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    // Structure of arrays storing its rows in segments of SegmentRows rows. Each segment is a single block
+    // holding one column per member (see detail::block_layout), which is never moved nor reallocated:
+    // appending a row never relocates the existing ones, and references on the rows stay valid until
+    // the rows are erased. Only the table of segments grows, and it only holds one pointer per column and segment.
+    template <typename MembersDesc, typename Allocator, size_t SegmentRows, typename... Types>
+    class segmented_vector_base
+    {
+    public:
+        using size_type = size_t;
+        using value_list = tuple<Types...>;
+        using reference_list = tuple<Types&...>;
+        using const_reference_list = tuple<const Types&...>;
+
+        static constexpr size_t members_count{ sizeof...(Types) };
+        static_assert(members_count == static_cast<size_t>(MembersDesc::Count), "The MembersDesc enum must match the number of types");
+
+        static constexpr size_type segment_rows{ SegmentRows };
+        static_assert(SegmentRows != 0 && (SegmentRows & (SegmentRows - 1)) == 0, "The number of rows of a segment must be a power of 2");
+        static_assert(!detail::member_layout<Types...>::has_groups, "Member groups are only supported by vector_base");
+
+        template<MembersDesc... Members>
+        using partial_ref_list = tuple<tuple_element_t<static_cast<size_t>(Members), value_list>&...>;
+
+        template<MembersDesc... Members>
+        using partial_const_ref_list = tuple<const tuple_element_t<static_cast<size_t>(Members), value_list>&...>;
+
+        template<MembersDesc Member>
+        using member_type = tuple_element_t<static_cast<size_t>(Member), value_list>;
+
+    private:
+        using layout = detail::block_layout<Types...>;
+        using block_unit = typename layout::unit;
+        using column_pointers = tuple<Types*...>;
+
+        static constexpr size_type segment_shift()
+        {
+            size_type shift{};
+            while ((size_type{ 1 } << shift) < SegmentRows)
+                ++shift;
+            return shift;
+        }
+
+        static constexpr size_type ms_segmentShift{ segment_shift() };
+        static constexpr size_type ms_segmentMask{ SegmentRows - 1 };
+
+        // Columns of each allocated segment
+        struct segment_table
+        {
+            column_pointers* segments{};
+            size_type count{};
+            size_type capacity{};
+        };
+
+        // Addressing policy of the iterators, see detail::indexed_iterator
+        struct segment_addressing
+        {
+            using table = segment_table;
+
+            template<size_t I>
+            using element_type = tuple_element_t<I, value_list>;
+
+            template<size_t I>
+            static element_type<I>* address(const table& _table, ptrdiff_t _index)
+            {
+                const size_type index{ static_cast<size_type>(_index) };
+                return get<I>(_table.segments[index >> ms_segmentShift]) + (index & ms_segmentMask);
+            }
+        };
+
+        template<template<MembersDesc...> typename Iterator, size_t... I>
+        static Iterator<static_cast<MembersDesc>(I)...> all_members(index_sequence<I...>);
+
+    public:
+        // The iterators hold a pointer to the segment table and a row index: they stay valid when segments are added.
+        template<MembersDesc... Members>
+        using partial_iterator = detail::indexed_iterator<segment_addressing, false, MembersDesc, Members...>;
+
+        template<MembersDesc... Members>
+        using partial_const_iterator = detail::indexed_iterator<segment_addressing, true, MembersDesc, Members...>;
+
+        using iterator = decltype(all_members<partial_iterator>(make_index_sequence<members_count>{}));
+        using const_iterator = decltype(all_members<partial_const_iterator>(make_index_sequence<members_count>{}));
+
+        segmented_vector_base() = default;
+
+        explicit segmented_vector_base(Allocator _allocator)
+            : m_allocator{ std::move(_allocator) }
+        {
+        }
+
+        segmented_vector_base(const segmented_vector_base& _other)
+            : m_allocator{ _other.m_allocator }
+        {
+            try
+            {
+                append_from(_other);
+            }
+            catch (...)
+            {
+                clear();
+                free_segments(0);
+                throw;
+            }
+        }
+
+        segmented_vector_base(segmented_vector_base&& _other) noexcept
+            : m_allocator{ std::move(_other.m_allocator) }
+        {
+            steal(_other);
+        }
+
+        ~segmented_vector_base()
+        {
+            clear();
+            free_segments(0);
+        }
+
+        segmented_vector_base& operator=(const segmented_vector_base& _other)
+        {
+            if (this != &_other)
+            {
+                clear();
+                append_from(_other);
+            }
+            return *this;
+        }
+
+        segmented_vector_base& operator=(segmented_vector_base&& _other)
+        {
+            if (this == &_other)
+                return *this;
+
+            // Same as vector_base: the segments are transferred when the allocator propagates or both allocators are equal,
+            // otherwise the rows are moved into segments owned by this allocator.
+            clear();
+            if constexpr (detail::propagate_on_move_assignment_v<Allocator>)
+            {
+                free_segments(0);
+                m_allocator = std::move(_other.m_allocator);
+                steal(_other);
+            }
+            else if constexpr (detail::is_always_equal_v<Allocator>)
+            {
+                free_segments(0);
+                steal(_other);
+            }
+            else if (detail::allocators_equal(m_allocator, _other.m_allocator))
+            {
+                free_segments(0);
+                steal(_other);
+            }
+            else
+            {
+                append_from(std::move(_other));
+                _other.clear();
+            }
+            return *this;
+        }
+
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        // Number of rows of the allocated segments
+        size_type capacity() const
+        {
+            return m_table.count * SegmentRows;
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        static constexpr size_type max_size()
+        {
+            return static_cast<size_type>(std::numeric_limits<ptrdiff_t>::max());
+        }
+
+        // Number of segments holding rows
+        size_type segment_count() const
+        {
+            return (m_size + ms_segmentMask) >> ms_segmentShift;
+        }
+
+        // Contiguous array of a member in a segment, holding SegmentRows rows except for the last segment
+        template<MembersDesc Member>
+        span<member_type<Member>> column(size_type _segment)
+        {
+            return { get<static_cast<size_t>(Member)>(m_table.segments[_segment]), segment_size(_segment) };
+        }
+
+        template<MembersDesc Member>
+        span<const member_type<Member>> column(size_type _segment) const
+        {
+            return { get<static_cast<size_t>(Member)>(m_table.segments[_segment]), segment_size(_segment) };
+        }
+
+        iterator begin()
+        {
+            return { &m_table, 0 };
+        }
+
+        iterator end()
+        {
+            return { &m_table, static_cast<ptrdiff_t>(m_size) };
+        }
+
+        const_iterator begin() const
+        {
+            return { &m_table, 0 };
+        }
+
+        const_iterator end() const
+        {
+            return { &m_table, static_cast<ptrdiff_t>(m_size) };
+        }
+
+        const_iterator cbegin() const
+        {
+            return begin();
+        }
+
+        const_iterator cend() const
+        {
+            return end();
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> begin()
+        {
+            return { &m_table, 0 };
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> end()
+        {
+            return { &m_table, static_cast<ptrdiff_t>(m_size) };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> begin() const
+        {
+            return { &m_table, 0 };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> end() const
+        {
+            return { &m_table, static_cast<ptrdiff_t>(m_size) };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> cbegin() const
+        {
+            return begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> cend() const
+        {
+            return end<Members...>();
+        }
+
+        // Allocates segments up to _capacity rows
+        void reserve(size_type _capacity)
+        {
+            if (_capacity > max_size())
+                throw length_error{ "soa::segmented_vector_base: capacity exceeds max_size()" };
+
+            while (capacity() < _capacity)
+                add_segment();
+        }
+
+        // Releases the segments which don't hold any row
+        void shrink_to_fit()
+        {
+            free_segments(segment_count());
+        }
+
+        void clear()
+        {
+            destroy_range(0, m_size);
+            m_size = 0;
+        }
+
+        template<typename... Args>
+        void push_back(Args&&... _args)
+        {
+            if constexpr (sizeof...(_args) == 1)
+            {
+                if constexpr (
+                    is_same_v<decay_t<Args>..., reference_list> ||
+                    is_same_v<decay_t<Args>..., const_reference_list> ||
+                    is_same_v<decay_t<Args>..., value_list>)
+                {
+                    push_back_internal(std::forward<Args>(_args)..., make_index_sequence<members_count>{});
+                }
+                else
+                {
+                    push_back_internal(forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+                }
+            }
+            else
+            {
+                push_back_internal(forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+            }
+        }
+
+        void pop_back()
+        {
+            destroy_range(m_size - 1, m_size);
+            --m_size;
+        }
+
+        void resize(size_type _size)
+        {
+            resize_internal(_size, [](const column_pointers& _columns, size_type _first, size_type _count) {
+                detail::value_construct_rows(_columns, _first, _count, make_index_sequence<members_count>{});
+            });
+        }
+
+        template<typename... Args>
+        void resize(size_type _size, Args&&... _args)
+        {
+            if constexpr (sizeof...(_args) == 1)
+            {
+                if constexpr (
+                    is_same_v<decay_t<Args>..., reference_list> ||
+                    is_same_v<decay_t<Args>..., const_reference_list> ||
+                    is_same_v<decay_t<Args>..., value_list>)
+                {
+                    resize_fill(_size, _args...);
+                }
+                else
+                {
+                    resize_fill(_size, forward_as_tuple(std::forward<Args>(_args)...));
+                }
+            }
+            else
+            {
+                resize_fill(_size, forward_as_tuple(std::forward<Args>(_args)...));
+            }
+        }
+
+        // Removes the row at _pos by moving the last row into it. Rows are never shifted in a segmented vector.
+        size_type erase_unordered(size_type _pos)
+        {
+            erase_unordered_internal(_pos, make_index_sequence<members_count>{});
+            return _pos;
+        }
+
+        template<MembersDesc I>
+        auto& at(size_type _index)
+        {
+            check_index(_index);
+            return *segment_addressing::template address<static_cast<size_t>(I)>(m_table, static_cast<ptrdiff_t>(_index));
+        }
+
+        template<MembersDesc I>
+        const auto& at(size_type _index) const
+        {
+            check_index(_index);
+            return *segment_addressing::template address<static_cast<size_t>(I)>(m_table, static_cast<ptrdiff_t>(_index));
+        }
+
+        reference_list ref_at(size_type _index)
+        {
+            check_index(_index);
+            return *iterator{ &m_table, static_cast<ptrdiff_t>(_index) };
+        }
+
+        const_reference_list ref_at(size_type _index) const
+        {
+            check_index(_index);
+            return *const_iterator{ &m_table, static_cast<ptrdiff_t>(_index) };
+        }
+
+        value_list value_at(size_type _index) const
+        {
+            return ref_at(_index);
+        }
+
+        reference_list front()
+        {
+            return ref_at(0);
+        }
+
+        const_reference_list front() const
+        {
+            return ref_at(0);
+        }
+
+        reference_list back()
+        {
+            return ref_at(m_size - 1);
+        }
+
+        const_reference_list back() const
+        {
+            return ref_at(m_size - 1);
+        }
+
+    private:
+        size_type segment_size(size_type _segment) const
+        {
+            const size_type first{ _segment << ms_segmentShift };
+            return m_size - first < SegmentRows ? m_size - first : SegmentRows;
+        }
+
+        void check_index(size_type _index) const
+        {
+            if (_index >= m_size)
+                throw out_of_range{ "soa::segmented_vector_base: index out of range" };
+        }
+
+        template<typename Tuple, size_t... I>
+        void push_back_internal(Tuple&& _args, index_sequence<I...> _sequence)
+        {
+            // The arguments may reference rows of this container: they stay valid since rows are never moved
+            if (m_size == capacity())
+                add_segment();
+
+            detail::construct_row(m_table.segments[m_size >> ms_segmentShift], m_size & ms_segmentMask, std::forward<Tuple>(_args), _sequence);
+            ++m_size;
+        }
+
+        template<typename Tuple>
+        void resize_fill(size_type _size, const Tuple& _values)
+        {
+            resize_internal(_size, [&_values](const column_pointers& _columns, size_type _first, size_type _count) {
+                detail::fill_construct_rows(_columns, _first, _count, _values, make_index_sequence<members_count>{});
+            });
+        }
+
+        // Constructs the new rows segment by segment through _construct. On exception, the size is unchanged.
+        template<typename Constructor>
+        void resize_internal(size_type _size, Constructor&& _construct)
+        {
+            if (_size <= m_size)
+            {
+                destroy_range(_size, m_size);
+                m_size = _size;
+                return;
+            }
+
+            reserve(_size);
+
+            const size_type size{ m_size };
+            try
+            {
+                while (m_size < _size)
+                {
+                    const size_type offset{ m_size & ms_segmentMask };
+                    const size_type count{ _size - m_size < SegmentRows - offset ? _size - m_size : SegmentRows - offset };
+                    _construct(m_table.segments[m_size >> ms_segmentShift], offset, count);
+                    m_size += count;
+                }
+            }
+            catch (...)
+            {
+                destroy_range(size, m_size);
+                m_size = size;
+                throw;
+            }
+        }
+
+        template<size_t... I>
+        void erase_unordered_internal(size_type _pos, index_sequence<I...>)
+        {
+            const ptrdiff_t pos{ static_cast<ptrdiff_t>(_pos) };
+            const ptrdiff_t last{ static_cast<ptrdiff_t>(m_size - 1) };
+            if (pos != last)
+            {
+                ((*segment_addressing::template address<I>(m_table, pos) = std::move(*segment_addressing::template address<I>(m_table, last))), ...);
+            }
+            pop_back();
+        }
+
+        // Copies or moves all the rows of _other at the end of this container, segment by segment
+        template<typename Other>
+        void append_from(Other&& _other)
+        {
+            reserve(m_size + _other.m_size);
+
+            size_type copied{};
+            while (copied < _other.m_size)
+            {
+                const size_type offset{ m_size & ms_segmentMask };
+                const size_type otherOffset{ copied & ms_segmentMask };
+                size_type count{ _other.m_size - copied };
+                count = count < SegmentRows - offset ? count : SegmentRows - offset;
+                count = count < SegmentRows - otherOffset ? count : SegmentRows - otherOffset;
+
+                const column_pointers from{ offset_columns(_other.m_table.segments[copied >> ms_segmentShift], otherOffset, make_index_sequence<members_count>{}) };
+                const column_pointers to{ offset_columns(m_table.segments[m_size >> ms_segmentShift], offset, make_index_sequence<members_count>{}) };
+                if constexpr (std::is_rvalue_reference_v<Other&&>)
+                    detail::move_rows(from, count, to, make_index_sequence<members_count>{});
+                else
+                    detail::copy_rows(from, count, to, make_index_sequence<members_count>{});
+
+                m_size += count;
+                copied += count;
+            }
+        }
+
+        template<size_t... I>
+        static column_pointers offset_columns(const column_pointers& _columns, size_type _offset, index_sequence<I...>)
+        {
+            return { (get<I>(_columns) + _offset)... };
+        }
+
+        void destroy_range(size_type _first, size_type _last)
+        {
+            while (_first < _last)
+            {
+                const size_type offset{ _first & ms_segmentMask };
+                const size_type count{ _last - _first < SegmentRows - offset ? _last - _first : SegmentRows - offset };
+                detail::destroy_rows(m_table.segments[_first >> ms_segmentShift], offset, count, make_index_sequence<members_count>{});
+                _first += count;
+            }
+        }
+
+        void add_segment()
+        {
+            if (m_table.count == m_table.capacity)
+                grow_table();
+
+            block_unit* block{ m_allocator.template allocate<block_unit>(layout::units(SegmentRows)) };
+            if (block == nullptr)
+                throw bad_alloc{};
+
+            ::new (static_cast<void*>(m_table.segments + m_table.count)) column_pointers{ layout::columns(block, SegmentRows) };
+            ++m_table.count;
+        }
+
+        void grow_table()
+        {
+            const size_type capacity{ m_table.capacity == 0 ? 4 : 2 * m_table.capacity };
+            column_pointers* segments{ m_allocator.template allocate<column_pointers>(capacity) };
+            if (segments == nullptr)
+                throw bad_alloc{};
+
+            std::uninitialized_copy_n(m_table.segments, m_table.count, segments);
+            std::destroy_n(m_table.segments, m_table.count);
+            if (m_table.segments != nullptr)
+                detail::free_block(m_allocator, m_table.segments, m_table.capacity);
+
+            m_table.segments = segments;
+            m_table.capacity = capacity;
+        }
+
+        // Frees the segments from _first, and the table when no segment remains
+        void free_segments(size_type _first)
+        {
+            for (size_type i = _first; i < m_table.count; ++i)
+            {
+                // The first column of a segment starts at the beginning of its block
+                detail::free_block(m_allocator, reinterpret_cast<block_unit*>(get<0>(m_table.segments[i])), layout::units(SegmentRows));
+                std::destroy_at(m_table.segments + i);
+            }
+            m_table.count = _first < m_table.count ? _first : m_table.count;
+
+            if (m_table.count == 0 && m_table.segments != nullptr)
+            {
+                detail::free_block(m_allocator, m_table.segments, m_table.capacity);
+                m_table = {};
+            }
+        }
+
+        void steal(segmented_vector_base& _other)
+        {
+            m_table = _other.m_table;
+            m_size = _other.m_size;
+            _other.m_table = {};
+            _other.m_size = 0;
+        }
+
+        Allocator m_allocator{};
+        segment_table m_table{};
+        size_type m_size{};
+    };
+
+    template<typename MembersDesc, typename... Types>
+    using segmented_vector = soa::segmented_vector_base<MembersDesc, soa::std_allocator, 1024, Types...>;
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    // Structure of arrays split in shards, each shard being a vector_base filled by a single thread, without any
+    // synchronization: a job of several tasks gives a shard to each task. The shards are then concatenated into a single table
+    // by merge() (moving the rows) or flatten() (copying them), column by column, the columns being copied by several threads
+    // with soa::par. The iterators walk the rows of all the shards, one shard after the other, without merging them.
+    // Each shard is on its own cache lines, so that threads growing their shards don't share the headers of the tables.
+    template <typename MembersDesc, typename Allocator, typename... Types>
+    class sharded_vector_base
+    {
+    public:
+        using rows_type = vector_base<MembersDesc, Allocator, Types...>;
+        using size_type = typename rows_type::size_type;
+
+        using value_list = typename rows_type::value_list;
+
+        template<MembersDesc Member>
+        using member_type = typename rows_type::template member_type<Member>;
+
+    private:
+        struct alignas(detail::cache_line_size) shard_slot
+        {
+            rows_type rows;
+        };
+
+        template<MembersDesc... Members, typename Rows>
+        static auto shard_begin(Rows& _rows)
+        {
+            if constexpr (sizeof...(Members) == 0)
+                return _rows.begin();
+            else
+                return _rows.template begin<Members...>();
+        }
+
+        template<MembersDesc... Members, typename Rows>
+        static auto shard_end(Rows& _rows)
+        {
+            if constexpr (sizeof...(Members) == 0)
+                return _rows.end();
+            else
+                return _rows.template end<Members...>();
+        }
+
+    public:
+        // Forward iterator on the rows of all the shards, for the given members or all the members when none is given
+        template<bool IsConst, MembersDesc... Members>
+        class joined_iterator
+        {
+            using slot_pointer = std::conditional_t<IsConst, const shard_slot*, shard_slot*>;
+            using shard_iterator = decltype(shard_begin<Members...>(std::declval<std::conditional_t<IsConst, const rows_type&, rows_type&>>()));
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename shard_iterator::value_type;
+            using difference_type = ptrdiff_t;
+            using reference = typename shard_iterator::reference;
+            using pointer = void;
+
+            joined_iterator() = default;
+
+            reference operator*() const
+            {
+                return *m_it;
+            }
+
+            template<MembersDesc Member>
+            decltype(auto) value()
+            {
+                return m_it.template value<Member>();
+            }
+
+            joined_iterator& operator++()
+            {
+                ++m_it;
+                skip_empty_shards();
+                return *this;
+            }
+
+            joined_iterator operator++(int)
+            {
+                joined_iterator previous{ *this };
+                ++*this;
+                return previous;
+            }
+
+            // Index of the shard of the row
+            size_t shard() const
+            {
+                return m_shard;
+            }
+
+            friend bool operator==(const joined_iterator& _lhs, const joined_iterator& _rhs)
+            {
+                return _lhs.m_shard == _rhs.m_shard && (_lhs.m_shard == _lhs.m_count || _lhs.m_it == _rhs.m_it);
+            }
+
+            friend bool operator!=(const joined_iterator& _lhs, const joined_iterator& _rhs)
+            {
+                return !(_lhs == _rhs);
+            }
+
+        private:
+            joined_iterator(slot_pointer _slots, size_t _shard, size_t _count)
+                : m_slots{ _slots }
+                , m_shard{ _shard }
+                , m_count{ _count }
+            {
+                if (m_shard < m_count)
+                {
+                    m_it = shard_begin<Members...>(m_slots[m_shard].rows);
+                    skip_empty_shards();
+                }
+            }
+
+            void skip_empty_shards()
+            {
+                while (m_it == shard_end<Members...>(m_slots[m_shard].rows))
+                {
+                    if (++m_shard == m_count)
+                        return;
+                    m_it = shard_begin<Members...>(m_slots[m_shard].rows);
+                }
+            }
+
+            slot_pointer m_slots{};
+            size_t m_shard{};
+            size_t m_count{};
+            shard_iterator m_it{};
+
+            friend class sharded_vector_base;
+        };
+
+        template<MembersDesc... Members>
+        using partial_iterator = joined_iterator<false, Members...>;
+
+        template<MembersDesc... Members>
+        using partial_const_iterator = joined_iterator<true, Members...>;
+
+        using iterator = partial_iterator<>;
+        using const_iterator = partial_const_iterator<>;
+
+        // One shard per hardware thread when _shards is 0
+        explicit sharded_vector_base(size_t _shards = 0, Allocator _allocator = Allocator())
+            : m_allocator{ _allocator }
+        {
+            const size_t shards{ _shards != 0 ? _shards : detail::policy_threads(parallel_policy{}) };
+            m_shards.reserve(shards);
+            for (size_t shard = 0; shard < shards; ++shard)
+                m_shards.push_back(shard_slot{ rows_type{ _allocator } });
+        }
+
+        size_t shard_count() const
+        {
+            return m_shards.size();
+        }
+
+        // The table of a shard, to be filled by a single thread at a time
+        rows_type& shard(size_t _shard)
+        {
+            return m_shards.at(_shard).rows;
+        }
+
+        const rows_type& shard(size_t _shard) const
+        {
+            return m_shards.at(_shard).rows;
+        }
+
+        // Number of rows of all the shards
+        size_type size() const
+        {
+            size_type size{};
+            for (const shard_slot& slot : m_shards)
+                size += slot.rows.size();
+            return size;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        void clear()
+        {
+            for (shard_slot& slot : m_shards)
+                slot.rows.clear();
+        }
+
+        // Moves the rows of all the shards, in the order of the shards, into a single table: the shards are left empty
+        template<typename Policy = sequential_policy>
+        rows_type merge(const Policy& _policy = {})
+        {
+            buffer<rows_type*> tables;
+            tables.reserve(m_shards.size());
+            for (shard_slot& slot : m_shards)
+                tables.push_back(&slot.rows);
+
+            merged_rows merged{ m_allocator };
+            merged.template append_tables<true>(tables.data(), tables.size(), _policy);
+            return rows_type{ std::move(merged) };
+        }
+
+        // Copies the rows of all the shards, in the order of the shards, into a single table
+        template<typename Policy = sequential_policy>
+        rows_type flatten(const Policy& _policy = {}) const
+        {
+            buffer<const rows_type*> tables;
+            tables.reserve(m_shards.size());
+            for (const shard_slot& slot : m_shards)
+                tables.push_back(&slot.rows);
+
+            merged_rows merged{ m_allocator };
+            merged.template append_tables<false>(tables.data(), tables.size(), _policy);
+            return rows_type{ std::move(merged) };
+        }
+
+        iterator begin()
+        {
+            return { m_shards.data(), 0, m_shards.size() };
+        }
+
+        iterator end()
+        {
+            return { m_shards.data(), m_shards.size(), m_shards.size() };
+        }
+
+        const_iterator begin() const
+        {
+            return { m_shards.data(), 0, m_shards.size() };
+        }
+
+        const_iterator end() const
+        {
+            return { m_shards.data(), m_shards.size(), m_shards.size() };
+        }
+
+        const_iterator cbegin() const
+        {
+            return begin();
+        }
+
+        const_iterator cend() const
+        {
+            return end();
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> begin()
+        {
+            return { m_shards.data(), 0, m_shards.size() };
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> end()
+        {
+            return { m_shards.data(), m_shards.size(), m_shards.size() };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> begin() const
+        {
+            return { m_shards.data(), 0, m_shards.size() };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> end() const
+        {
+            return { m_shards.data(), m_shards.size(), m_shards.size() };
+        }
+
+    private:
+        // Gives access to the concatenation of tables of vector_base
+        struct merged_rows : rows_type
+        {
+            using rows_type::rows_type;
+            using rows_type::append_tables;
+        };
+
+        Allocator m_allocator;
+        buffer<shard_slot> m_shards;
+    };
+
+    template<typename MembersDesc, typename... Types>
+    using sharded_vector = soa::sharded_vector_base<MembersDesc, soa::std_allocator, Types...>;
+}
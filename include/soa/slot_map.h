@@ -0,0 +1,386 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    // Stable reference on a row of a slot_map: the index of its slot, and the generation of the slot when the row was inserted.
+    // Erasing the row increments the generation of the slot, so that the handles on it are detected as stale.
+    struct slot_handle
+    {
+        static constexpr uint32_t null_index{ std::numeric_limits<uint32_t>::max() };
+
+        uint32_t index{ null_index };
+        uint32_t generation{};
+
+        friend bool operator==(const slot_handle& _lhs, const slot_handle& _rhs)
+        {
+            return _lhs.index == _rhs.index && _lhs.generation == _rhs.generation;
+        }
+
+        friend bool operator!=(const slot_handle& _lhs, const slot_handle& _rhs)
+        {
+            return !(_lhs == _rhs);
+        }
+    };
+
+    // Structure of arrays whose rows are referenced by handles which stay valid while the rows move.
+    // The rows are packed in a vector_base, so that iterating on them stays contiguous: erasing a row moves the last row into it.
+    // A table of slots maps the handles to the rows, and each row knows its slot: looking up a handle, inserting and erasing
+    // are constant time. The slots of the erased rows are reused by the next insertions, with a new generation.
+    // Generations are 32 bits: a slot reused 2^32 times would accept the handles of its first row again.
+    template <typename MembersDesc, typename Allocator, typename... Types>
+    class slot_map_base
+    {
+    public:
+        using rows_type = vector_base<MembersDesc, Allocator, Types...>;
+        using size_type = typename rows_type::size_type;
+        using handle = slot_handle;
+
+        using value_list = typename rows_type::value_list;
+        using reference_list = typename rows_type::reference_list;
+        using const_reference_list = typename rows_type::const_reference_list;
+
+        template<MembersDesc Member>
+        using member_type = typename rows_type::template member_type<Member>;
+
+        using iterator = typename rows_type::iterator;
+        using const_iterator = typename rows_type::const_iterator;
+
+        template<MembersDesc... Members>
+        using partial_iterator = typename rows_type::template partial_iterator<Members...>;
+
+        template<MembersDesc... Members>
+        using partial_const_iterator = typename rows_type::template partial_const_iterator<Members...>;
+
+        static constexpr size_type npos{ std::numeric_limits<size_type>::max() };
+
+    private:
+        // A live slot holds the index of its row, a free one the index of the next free slot
+        enum class slot_members
+        {
+            Index,
+            Generation,
+            Count
+        };
+
+        enum class owner_members
+        {
+            Slot,
+            Count
+        };
+
+        using slots_type = vector_base<slot_members, Allocator, uint32_t, uint32_t>;
+        using owners_type = vector_base<owner_members, Allocator, uint32_t>;
+
+    public:
+        slot_map_base() = default;
+
+        explicit slot_map_base(Allocator _allocator)
+            : m_rows{ _allocator }
+            , m_owners{ _allocator }
+            , m_slots{ std::move(_allocator) }
+        {
+        }
+
+        slot_map_base(const slot_map_base&) = default;
+        slot_map_base& operator=(const slot_map_base&) = default;
+
+        // The moved from map is left empty, without any slot
+        slot_map_base(slot_map_base&& _other)
+            : m_rows{ std::move(_other.m_rows) }
+            , m_owners{ std::move(_other.m_owners) }
+            , m_slots{ std::move(_other.m_slots) }
+            , m_freeSlot{ std::exchange(_other.m_freeSlot, handle::null_index) }
+        {
+        }
+
+        slot_map_base& operator=(slot_map_base&& _other)
+        {
+            if (this != &_other)
+            {
+                m_rows = std::move(_other.m_rows);
+                m_owners = std::move(_other.m_owners);
+                m_slots = std::move(_other.m_slots);
+                m_freeSlot = std::exchange(_other.m_freeSlot, handle::null_index);
+            }
+            return *this;
+        }
+
+        size_type size() const
+        {
+            return m_rows.size();
+        }
+
+        size_type capacity() const
+        {
+            return m_rows.capacity();
+        }
+
+        bool empty() const
+        {
+            return m_rows.empty();
+        }
+
+        static constexpr size_type max_size()
+        {
+            return handle::null_index;
+        }
+
+        void reserve(size_type _capacity)
+        {
+            if (_capacity > max_size())
+                throw length_error{ "soa::slot_map: too many rows" };
+
+            m_rows.reserve(_capacity);
+            m_owners.reserve(_capacity);
+            m_slots.reserve(_capacity);
+        }
+
+        void shrink_to_fit()
+        {
+            m_rows.shrink_to_fit();
+            m_owners.shrink_to_fit();
+        }
+
+        // Erases all the rows: all the handles become stale
+        void clear()
+        {
+            for (size_type i = 0; i < m_owners.size(); ++i)
+                release_slot(m_owners.template column<owner_members::Slot>()[i]);
+            m_rows.clear();
+            m_owners.clear();
+        }
+
+        // Appends a row, built from the values of its members, and returns its handle
+        template<typename... Args>
+        handle insert(Args&&... _args)
+        {
+            if (size() == max_size())
+                throw length_error{ "soa::slot_map: too many rows" };
+
+            const uint32_t row{ static_cast<uint32_t>(size()) };
+            if (m_freeSlot == handle::null_index)
+            {
+                reserve_next(m_slots);
+                reserve_next(m_owners);
+                m_rows.push_back(std::forward<Args>(_args)...);
+                m_slots.push_back(row, uint32_t{});
+                m_owners.push_back(static_cast<uint32_t>(m_slots.size() - 1));
+                return { static_cast<uint32_t>(m_slots.size() - 1), 0 };
+            }
+
+            reserve_next(m_owners);
+            m_rows.push_back(std::forward<Args>(_args)...);
+
+            const uint32_t slot{ m_freeSlot };
+            uint32_t& index{ m_slots.template column<slot_members::Index>()[slot] };
+            m_freeSlot = index;
+            index = row;
+            m_owners.push_back(slot);
+            return { slot, m_slots.template column<slot_members::Generation>()[slot] };
+        }
+
+        // Erases the row of a handle, moving the last row into it. Returns false when the handle is stale.
+        bool erase(handle _handle)
+        {
+            const size_type row{ find(_handle) };
+            if (row == npos)
+                return false;
+
+            erase_row(row);
+            return true;
+        }
+
+        // Erases the row at an index of the dense rows, moving the last row into it
+        void erase_at(size_type _index)
+        {
+            if (_index >= size())
+                throw out_of_range{ "soa::slot_map: index out of range" };
+
+            erase_row(_index);
+        }
+
+        bool contains(handle _handle) const
+        {
+            return find(_handle) != npos;
+        }
+
+        // Index of the row of a handle in the dense rows, or npos when the handle is stale. Invalidated by erasures.
+        size_type find(handle _handle) const
+        {
+            if (_handle.index >= m_slots.size() || m_slots.template column<slot_members::Generation>()[_handle.index] != _handle.generation)
+                return npos;
+            return m_slots.template column<slot_members::Index>()[_handle.index];
+        }
+
+        // Handle of the row at an index of the dense rows
+        handle handle_at(size_type _index) const
+        {
+            const uint32_t slot{ m_owners.template column<owner_members::Slot>()[_index] };
+            return { slot, m_slots.template column<slot_members::Generation>()[slot] };
+        }
+
+        template<MembersDesc Member>
+        auto& at(handle _handle)
+        {
+            return m_rows.template at<Member>(checked_find(_handle));
+        }
+
+        template<MembersDesc Member>
+        const auto& at(handle _handle) const
+        {
+            return m_rows.template at<Member>(checked_find(_handle));
+        }
+
+        reference_list ref_at(handle _handle)
+        {
+            return m_rows.ref_at(checked_find(_handle));
+        }
+
+        const_reference_list ref_at(handle _handle) const
+        {
+            return m_rows.ref_at(checked_find(_handle));
+        }
+
+        value_list value_at(handle _handle) const
+        {
+            return m_rows.value_at(checked_find(_handle));
+        }
+
+        // Access to the dense rows, by index
+        template<MembersDesc Member>
+        auto& at(size_type _index)
+        {
+            return m_rows.template at<Member>(_index);
+        }
+
+        template<MembersDesc Member>
+        const auto& at(size_type _index) const
+        {
+            return m_rows.template at<Member>(_index);
+        }
+
+        // The iterators and columns give access to the values of the dense rows, in no particular order
+        iterator begin()
+        {
+            return m_rows.begin();
+        }
+
+        iterator end()
+        {
+            return m_rows.end();
+        }
+
+        const_iterator begin() const
+        {
+            return m_rows.begin();
+        }
+
+        const_iterator end() const
+        {
+            return m_rows.end();
+        }
+
+        const_iterator cbegin() const
+        {
+            return m_rows.cbegin();
+        }
+
+        const_iterator cend() const
+        {
+            return m_rows.cend();
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> begin()
+        {
+            return m_rows.template begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> end()
+        {
+            return m_rows.template end<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> begin() const
+        {
+            return m_rows.template begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> end() const
+        {
+            return m_rows.template end<Members...>();
+        }
+
+        template<MembersDesc Member>
+        span<member_type<Member>> column()
+        {
+            return m_rows.template column<Member>();
+        }
+
+        template<MembersDesc Member>
+        span<const member_type<Member>> column() const
+        {
+            return m_rows.template column<Member>();
+        }
+
+        // Read only access to the dense rows, for the other algorithms of vector_base (slices, indexed iterators...)
+        const rows_type& rows() const
+        {
+            return m_rows;
+        }
+
+    private:
+        // Grows a table geometrically when it is full, so that its next push_back doesn't throw
+        template<typename Table>
+        static void reserve_next(Table& _table)
+        {
+            if (_table.size() == _table.capacity())
+                _table.reserve(_table.capacity() != 0 ? 2 * _table.capacity() : 1);
+        }
+
+        size_type checked_find(handle _handle) const
+        {
+            const size_type row{ find(_handle) };
+            if (row == npos)
+                throw out_of_range{ "soa::slot_map: stale handle" };
+            return row;
+        }
+
+        void erase_row(size_type _row)
+        {
+            auto owners{ m_owners.template column<owner_members::Slot>() };
+            const uint32_t slot{ owners[_row] };
+            const size_type last{ size() - 1 };
+
+            m_rows.erase_unordered(_row);
+            if (_row != last)
+            {
+                owners[_row] = owners[last];
+                m_slots.template column<slot_members::Index>()[owners[_row]] = static_cast<uint32_t>(_row);
+            }
+            m_owners.pop_back();
+            release_slot(slot);
+        }
+
+        // Invalidates the handles of a slot, and pushes it on the free list
+        void release_slot(uint32_t _slot)
+        {
+            ++m_slots.template column<slot_members::Generation>()[_slot];
+            m_slots.template column<slot_members::Index>()[_slot] = m_freeSlot;
+            m_freeSlot = _slot;
+        }
+
+        rows_type m_rows;
+        owners_type m_owners;
+        slots_type m_slots;
+        uint32_t m_freeSlot{ handle::null_index };
+    };
+
+    template<typename MembersDesc, typename... Types>
+    using slot_map = soa::slot_map_base<MembersDesc, soa::std_allocator, Types...>;
+}
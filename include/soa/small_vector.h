@@ -0,0 +1,234 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    namespace detail
+    {
+        // Fallback of an inline_allocator which can't allocate anything beyond its inline block
+        struct no_fallback
+        {
+        };
+
+        // Allocator holding a single block of Units units inline, used for the first allocation which fits in it.
+        // Other allocations are forwarded to Fallback, or throw length_error when there is no fallback.
+        // Copies don't share nor copy the inline block: each container owns its own.
+        template<typename Unit, size_t Units, typename Fallback>
+        class inline_allocator
+        {
+        public:
+            using inline_storage = std::true_type;
+
+            // The inline block is left uninitialized
+            inline_allocator()
+            {
+            }
+
+            // For the fallbacks which can't be default constructed, such as arena_allocator or pool_allocator
+            explicit inline_allocator(Fallback _fallback)
+                : m_fallback{ std::move(_fallback) }
+            {
+            }
+
+            inline_allocator(const inline_allocator& _other)
+                : m_fallback{ _other.m_fallback }
+            {
+            }
+
+            inline_allocator& operator=(const inline_allocator&)
+            {
+                return *this;
+            }
+
+            template<typename T>
+            T* allocate(size_t _count)
+            {
+                static_assert(alignof(T) <= alignof(Unit), "The inline block is not aligned for this type");
+                if (!m_used && _count <= sizeof(m_block) / sizeof(T))
+                {
+                    m_used = true;
+                    return reinterpret_cast<T*>(m_block);
+                }
+
+                if constexpr (is_same_v<Fallback, no_fallback>)
+                    throw length_error{ "soa::static_vector: capacity exceeded" };
+                else
+                    return m_fallback.template allocate<T>(_count);
+            }
+
+            template<typename T>
+            void free(T* _ptr, size_t _count)
+            {
+                if (is_inline(_ptr))
+                    m_used = false;
+                else if constexpr (!is_same_v<Fallback, no_fallback>)
+                    free_block(m_fallback, _ptr, _count);
+            }
+
+            const Fallback& fallback() const
+            {
+                return m_fallback;
+            }
+
+            template<typename T>
+            bool is_inline(const T* _ptr) const
+            {
+                return static_cast<const void*>(_ptr) == static_cast<const void*>(m_block);
+            }
+
+        private:
+            Unit m_block[Units];
+            bool m_used{};
+            Fallback m_fallback{};
+        };
+
+        template<typename Fallback, size_t Rows, typename... Types>
+        using inline_allocator_for = inline_allocator<typename member_layout<Types...>::block::unit, member_layout<Types...>::block::units(Rows), Fallback>;
+    }
+
+    // Structure of arrays storing up to Capacity rows inline, without any heap allocation.
+    // It has the interface of vector_base, with a fixed capacity: growing beyond Capacity throws length_error.
+    // The columns being inside the object, moving it moves the rows one by one.
+    template <typename MembersDesc, size_t Capacity, typename... Types>
+    class static_vector : public vector_base<MembersDesc, detail::inline_allocator_for<detail::no_fallback, Capacity, Types...>, Types...>
+    {
+        using base = vector_base<MembersDesc, detail::inline_allocator_for<detail::no_fallback, Capacity, Types...>, Types...>;
+
+    public:
+        using size_type = typename base::size_type;
+
+        static_assert(Capacity != 0, "A static_vector must hold at least one row");
+
+        static_vector()
+        {
+            base::reserve(Capacity);
+        }
+
+        explicit static_vector(size_type _count)
+            : static_vector{}
+        {
+            base::resize(_count);
+        }
+
+        template<typename... Args>
+        static_vector(size_type _count, Args&&... _args)
+            : static_vector{}
+        {
+            base::resize(_count, std::forward<Args>(_args)...);
+        }
+
+        static_vector(const static_vector& _other)
+            : static_vector{}
+        {
+            base::operator=(_other);
+        }
+
+        static_vector(static_vector&& _other)
+            : static_vector{}
+        {
+            base::operator=(std::move(_other));
+        }
+
+        static_vector& operator=(const static_vector& _other)
+        {
+            base::operator=(_other);
+            return *this;
+        }
+
+        static_vector& operator=(static_vector&& _other)
+        {
+            base::operator=(std::move(_other));
+            return *this;
+        }
+
+        static constexpr size_type max_size()
+        {
+            return Capacity;
+        }
+
+        // The capacity is fixed
+        void shrink_to_fit()
+        {
+        }
+    };
+
+    // Structure of arrays storing up to InlineRows rows inline, and moving to memory allocated from Allocator beyond.
+    // It has the interface of vector_base. The inline rows are used again when shrink_to_fit is called with few enough rows.
+    // Copies and moves use a copy of the allocator of the source.
+    template <typename MembersDesc, typename Allocator, size_t InlineRows, typename... Types>
+    class small_vector_base : public vector_base<MembersDesc, detail::inline_allocator_for<Allocator, InlineRows, Types...>, Types...>
+    {
+        using base = vector_base<MembersDesc, detail::inline_allocator_for<Allocator, InlineRows, Types...>, Types...>;
+
+    public:
+        using size_type = typename base::size_type;
+
+        static constexpr size_type inline_rows{ InlineRows };
+        static_assert(InlineRows != 0, "A small_vector must hold at least one row inline");
+
+        small_vector_base()
+        {
+            base::reserve(InlineRows);
+        }
+
+        explicit small_vector_base(Allocator _allocator)
+            : base{ detail::inline_allocator_for<Allocator, InlineRows, Types...>{ std::move(_allocator) } }
+        {
+            base::reserve(InlineRows);
+        }
+
+        explicit small_vector_base(size_type _count)
+            : small_vector_base{}
+        {
+            base::resize(_count);
+        }
+
+        template<typename... Args>
+        small_vector_base(size_type _count, Args&&... _args)
+            : small_vector_base{}
+        {
+            base::resize(_count, std::forward<Args>(_args)...);
+        }
+
+        small_vector_base(const small_vector_base& _other)
+            : small_vector_base{ _other.allocator().fallback() }
+        {
+            base::operator=(_other);
+        }
+
+        small_vector_base(small_vector_base&& _other)
+            : small_vector_base{ _other.allocator().fallback() }
+        {
+            base::operator=(std::move(_other));
+        }
+
+        small_vector_base& operator=(const small_vector_base& _other)
+        {
+            base::operator=(_other);
+            return *this;
+        }
+
+        small_vector_base& operator=(small_vector_base&& _other)
+        {
+            base::operator=(std::move(_other));
+            return *this;
+        }
+
+        // True while the rows are stored inline
+        bool is_inline() const
+        {
+            return base::capacity() <= InlineRows;
+        }
+
+        // Releases the unused capacity, going back to the inline rows when the size allows it
+        void shrink_to_fit()
+        {
+            if (!is_inline())
+                base::reallocate_exact(base::size() > InlineRows ? base::size() : InlineRows);
+        }
+    };
+
+    template<typename MembersDesc, size_t InlineRows, typename... Types>
+    using small_vector = soa::small_vector_base<MembersDesc, soa::std_allocator, InlineRows, Types...>;
+}
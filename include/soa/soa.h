@@ -8,7 +8,23 @@
 #include <type_traits>
 #include <functional>
 #include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <memory.h>
+#include <new>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#if __cplusplus >= 202002L
+#include <span>
+#endif
 
 namespace soa
 {
@@ -24,6 +40,10 @@ namespace soa
     template <typename T, size_t Size>
     using array = std::array<T, Size>;
 
+    // Temporary storage used internally by some algorithms
+    template <typename T>
+    using buffer = std::vector<T>;
+
     template <size_t Size>
     using make_index_sequence = std::make_index_sequence<Size>;
 
@@ -47,731 +67,3971 @@ namespace soa
     using std::make_tuple;
     using std::forward_as_tuple;
 
+    using std::bad_alloc;
+    using std::length_error;
+    using std::out_of_range;
+
 #ifndef _WIN32
-    using std::aligned_alloc;
+    using std::malloc;
+    using std::realloc;
     using std::free;
 #endif
 }
 
 #endif
 
+#include <cassert>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace soa
 {
-    template <typename MembersDesc, typename Allocator, typename... Types>
-    class vector_base
+    namespace detail
     {
-    public:
-        using size_type = size_t;
-        using value_list = tuple<Types...>;
-        using reference_list = tuple<Types&...>;
-        using const_reference_list = tuple<const Types&...>;
-
-        static constexpr size_t members_count{ sizeof...(Types) };
-        static_assert(members_count == static_cast<size_t>(MembersDesc::Count), "The MembersDesc enum must match the number of types");
-
-        template<MembersDesc... Members>
-        using partial_ref_list = tuple<tuple_element_t<static_cast<size_t>(Members), value_list>&...>;
-
-        template<MembersDesc... Members>
-        using partial_const_ref_list = tuple<const tuple_element_t<static_cast<size_t>(Members), value_list>&...>;
+        constexpr size_t cache_line_size{ 64 };
 
-    public:
+        template<typename... Types>
+        constexpr size_t max_alignment()
+        {
+            size_t alignment{ cache_line_size };
+            ((alignment = alignof(Types) > alignment ? alignof(Types) : alignment), ...);
+            return alignment;
+        }
 
-        class const_iterator
+        // Layout of a block storing one column per type, for a given capacity (number of rows).
+        // Columns are stored one after the other, each one starting on an `alignment` boundary,
+        // so a single allocation holds the whole structure of arrays.
+        template<typename... Types>
+        struct block_layout
         {
-        public:
-            using pointer = tuple<const Types*...>;
-            using iterator_category = random_access_iterator_tag;
-            using difference_type = ptrdiff_t;
-            using reference = const_reference_list;
-            using value_type = value_list;
+            static constexpr size_t alignment{ max_alignment<Types...>() };
 
-            reference operator*() const
+            // Allocation unit, so that any allocator returns memory aligned for all the columns
+            struct alignas(alignment) unit
             {
-                return convert<reference>(make_index_sequence<members_count>{});
-            }
+                unsigned char bytes[alignment];
+            };
 
-            template<MembersDesc MemberIndex>
-            const auto& value() const
+            static constexpr size_t column_units(size_t _capacity, size_t _elementSize)
             {
-                return *get<static_cast<size_t>(MemberIndex)>(m_ptr);
+                return (_capacity * _elementSize + alignment - 1) / alignment;
             }
 
-            const_iterator& operator++()
+            static constexpr size_t units(size_t _capacity)
             {
-                apply([](auto*&... _obj) { (++_obj, ...); }, m_ptr);
-                return *this;
+                return (column_units(_capacity, sizeof(Types)) + ...);
             }
 
-            const_iterator operator++(int)
+            static constexpr size_t max_rows()
             {
-                iterator ret = *this;
-                apply([](auto*&... _obj) { (_obj++, ...); }, m_ptr);
-                return ret;
+                return (std::numeric_limits<size_t>::max() - sizeof...(Types) * alignment) / (sizeof(Types) + ...);
             }
 
-            const_iterator& operator--()
+            static tuple<Types*...> columns(unit* _block, size_t _capacity)
             {
-                apply([](auto*&... _obj) { (--_obj, ...); }, m_ptr);
-                return *this;
+                // Braced initialization guarantees the left to right evaluation of the offsets
+                unit* cursor{ _block };
+                return tuple<Types*...>{ next_column<Types>(cursor, _capacity)... };
             }
 
-            const_iterator operator--(int)
+        private:
+            template<typename T>
+            static T* next_column(unit*& _cursor, size_t _capacity)
             {
-                iterator ret = *this;
-                apply([](auto*&... _obj) { (_obj--, ...); }, m_ptr);
-                return ret;
+                T* column{ reinterpret_cast<T*>(_cursor) };
+                _cursor += column_units(_capacity, sizeof(T));
+                return column;
             }
+        };
 
-            difference_type operator-(const const_iterator& _other) const
-            {
-                return get<0>(m_ptr) - get<0>(_other.m_ptr);
-            }
+        // Trivially copyable elements are copied and shifted as raw bytes.
+        // Non overlapping ranges:
+        template<typename T>
+        void copy_bytes(const T* _from, size_t _count, T* _to)
+        {
+            if (_count != 0)
+                std::memcpy(static_cast<void*>(_to), static_cast<const void*>(_from), _count * sizeof(T));
+        }
 
-            bool operator==(const const_iterator& _other) const
-            {
-                return m_ptr == _other.m_ptr;
-            }
+        // Possibly overlapping ranges:
+        template<typename T>
+        void move_bytes(const T* _from, size_t _count, T* _to)
+        {
+            if (_count != 0)
+                std::memmove(static_cast<void*>(_to), static_cast<const void*>(_from), _count * sizeof(T));
+        }
 
-            bool operator!=(const const_iterator& _other) const
-            {
-                return m_ptr != _other.m_ptr;
-            }
+        // Allocators can optionally provide `T* reallocate<T>(T* _ptr, size_t _count, size_t _newCount)`, growing a block
+        // in place when possible, and returning nullptr when it can't (the original block being left untouched)
+        template<typename Allocator, typename T, typename = void>
+        constexpr bool has_reallocate_v = false;
 
-        protected:
-            pointer m_ptr{};
+        template<typename Allocator, typename T>
+        constexpr bool has_reallocate_v<Allocator, T, std::void_t<decltype(std::declval<Allocator&>().template reallocate<T>(std::declval<T*>(), size_t{}, size_t{}))>> = true;
 
-            template<typename... Args>
-            const_iterator(Args... _args)
-                : m_ptr{ make_tuple(_args...) }
-            {
-            }
+        // Allocators can optionally provide `void free<T>(T* _ptr, size_t _count)`, receiving the size given to allocate
+        template<typename Allocator, typename T, typename = void>
+        constexpr bool has_sized_free_v = false;
 
-            template<typename R, size_t... I>
-            R convert(index_sequence<I...>) const
-            {
-                return { (*get<I>(m_ptr))... };
-            }
+        template<typename Allocator, typename T>
+        constexpr bool has_sized_free_v<Allocator, T, std::void_t<decltype(std::declval<Allocator&>().template free<T>(std::declval<T*>(), size_t{}))>> = true;
 
-            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
-        };
+        template<typename T, typename Allocator>
+        void free_block(Allocator& _allocator, T* _ptr, size_t _count)
+        {
+            if constexpr (has_sized_free_v<Allocator, T>)
+                _allocator.template free<T>(_ptr, _count);
+            else
+                _allocator.template free<T>(_ptr);
+        }
 
-        class iterator : public const_iterator
+        // Allocator equality and propagation, as in std::allocator_traits: stateless allocators always compare equal,
+        // the others through their operator== when they have one. Allocators are only transferred between containers
+        // when they define propagate_on_container_copy_assignment, propagate_on_container_move_assignment or
+        // propagate_on_container_swap as std::true_type.
+        template<typename Allocator, typename = void>
+        constexpr bool is_always_equal_v = std::is_empty_v<Allocator>;
+
+        template<typename Allocator>
+        constexpr bool is_always_equal_v<Allocator, std::void_t<typename Allocator::is_always_equal>> = Allocator::is_always_equal::value;
+
+        template<typename Allocator, typename = void>
+        constexpr bool has_equality_v = false;
+
+        template<typename Allocator>
+        constexpr bool has_equality_v<Allocator, std::void_t<decltype(std::declval<const Allocator&>() == std::declval<const Allocator&>())>> = true;
+
+        template<typename Allocator>
+        bool allocators_equal(const Allocator& _lhs, const Allocator& _rhs)
         {
-        public:
-            using pointer = tuple<Types*...>;
-            using iterator_category = random_access_iterator_tag;
-            using difference_type = ptrdiff_t;
-            using reference = reference_list;
-            using value_type = value_list;
+            if constexpr (is_always_equal_v<Allocator>)
+                return true;
+            else if constexpr (has_equality_v<Allocator>)
+                return _lhs == _rhs;
+            else
+                return &_lhs == &_rhs;
+        }
 
-            iterator() = default;
+        template<typename Allocator, typename = void>
+        constexpr bool propagate_on_copy_assignment_v = false;
 
-            reference operator*() const
-            {
-                return convert<reference>(make_index_sequence<members_count>{});
-            }
+        template<typename Allocator>
+        constexpr bool propagate_on_copy_assignment_v<Allocator, std::void_t<typename Allocator::propagate_on_container_copy_assignment>> = Allocator::propagate_on_container_copy_assignment::value;
 
-            template<MembersDesc MemberIndex>
-            auto& value()
+        template<typename Allocator, typename = void>
+        constexpr bool propagate_on_move_assignment_v = false;
+
+        template<typename Allocator>
+        constexpr bool propagate_on_move_assignment_v<Allocator, std::void_t<typename Allocator::propagate_on_container_move_assignment>> = Allocator::propagate_on_container_move_assignment::value;
+
+        template<typename Allocator, typename = void>
+        constexpr bool propagate_on_swap_v = false;
+
+        template<typename Allocator>
+        constexpr bool propagate_on_swap_v<Allocator, std::void_t<typename Allocator::propagate_on_container_swap>> = Allocator::propagate_on_container_swap::value;
+
+        // Allocators returning blocks stored inside the allocator object declare `using inline_storage = std::true_type;`:
+        // such blocks are never transferred between containers, their rows are moved to a block of the receiving container
+        template<typename Allocator, typename = void>
+        constexpr bool has_inline_storage_v = false;
+
+        template<typename Allocator>
+        constexpr bool has_inline_storage_v<Allocator, std::void_t<typename Allocator::inline_storage>> = Allocator::inline_storage::value;
+
+        // Same as std::uninitialized_move_n, but copies when moving could throw, to keep the source intact
+        template<typename T>
+        constexpr bool relocates_by_copy_v = !std::is_trivially_copyable_v<T> && !std::is_nothrow_move_constructible_v<T> && std::is_copy_constructible_v<T>;
+
+        template<typename T>
+        void uninitialized_move_if_noexcept(T* _from, size_t _count, T* _to)
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+                copy_bytes(_from, _count, _to);
+            else if constexpr (!relocates_by_copy_v<T>)
+                std::uninitialized_move_n(_from, _count, _to);
+            else
+                std::uninitialized_copy_n(_from, _count, _to);
+        }
+
+        // Construction and destruction of rows from a tuple of column pointers. On exception, no element remains constructed.
+        template<typename... Columns, size_t... I>
+        void destroy_rows(const tuple<Columns*...>& _columns, size_t _first, size_t _count, index_sequence<I...>)
+        {
+            (std::destroy_n(get<I>(_columns) + _first, _count), ...);
+        }
+
+        template<typename... Columns, typename Tuple, size_t... I>
+        void construct_row(const tuple<Columns*...>& _columns, size_t _index, Tuple&& _args, index_sequence<I...>)
+        {
+            size_t constructed{};
+            try
             {
-                return *const_cast<tuple_element_t<static_cast<size_t>(MemberIndex), pointer>>(get<static_cast<size_t>(MemberIndex)>(this->m_ptr));
+                ((::new (static_cast<void*>(get<I>(_columns) + _index)) tuple_element_t<I, tuple<Columns...>>(get<I>(std::forward<Tuple>(_args))), ++constructed), ...);
             }
-
-            iterator& operator++()
+            catch (...)
             {
-                const_iterator::operator++();
-                return *this;
+                ((I < constructed ? std::destroy_at(get<I>(_columns) + _index) : void()), ...);
+                throw;
             }
+        }
 
-            iterator operator++(int)
+        template<typename... Columns, size_t... I>
+        void value_construct_rows(const tuple<Columns*...>& _columns, size_t _first, size_t _count, index_sequence<I...>)
+        {
+            size_t constructed{};
+            try
             {
-                iterator ret = *this;
-                const_iterator::operator++();
-                return ret;
+                ((std::uninitialized_value_construct_n(get<I>(_columns) + _first, _count), ++constructed), ...);
             }
-
-            iterator& operator--()
+            catch (...)
             {
-                const_iterator::operator--();
-                return *this;
+                ((I < constructed ? (void)std::destroy_n(get<I>(_columns) + _first, _count) : void()), ...);
+                throw;
             }
+        }
 
-            iterator operator--(int)
+        template<typename... Columns, typename Tuple, size_t... I>
+        void fill_construct_rows(const tuple<Columns*...>& _columns, size_t _first, size_t _count, const Tuple& _values, index_sequence<I...>)
+        {
+            size_t constructed{};
+            try
             {
-                iterator ret = *this;
-                const_iterator::operator--();
-                return ret;
+                ((std::uninitialized_fill_n(get<I>(_columns) + _first, _count, get<I>(_values)), ++constructed), ...);
             }
-
-        private:
-            using const_iterator::const_iterator;
-
-            template<typename R, size_t... I>
-            R convert(index_sequence<I...>) const
+            catch (...)
             {
-                return { (*const_cast<tuple_element_t<I, pointer>>(get<I>(this->m_ptr)))... };
+                ((I < constructed ? (void)std::destroy_n(get<I>(_columns) + _first, _count) : void()), ...);
+                throw;
             }
+        }
 
-            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
-        };
+        template<typename T>
+        void copy_column(const T* _from, size_t _count, T* _to)
+        {
+            if constexpr (std::is_trivially_copyable_v<T>)
+                copy_bytes(_from, _count, _to);
+            else
+                std::uninitialized_copy_n(_from, _count, _to);
+        }
 
-        template<MembersDesc... Members>
-        class partial_const_iterator
+        template<typename T>
+        void move_column(T* _from, size_t _count, T* _to)
         {
-        public:
-            using pointer = tuple<const tuple_element_t<static_cast<size_t>(Members), value_list>*...>;
-            using iterator_category = random_access_iterator_tag;
-            using difference_type = ptrdiff_t;
-            using reference = partial_const_ref_list<Members...>;
-            using value_type = void;
+            if constexpr (std::is_trivially_copyable_v<T>)
+                copy_bytes(_from, _count, _to);
+            else
+                std::uninitialized_move_n(_from, _count, _to);
+        }
 
-            reference operator*() const
+        template<typename... Columns, size_t... I>
+        void copy_rows(const tuple<Columns*...>& _from, size_t _count, const tuple<Columns*...>& _to, index_sequence<I...>)
+        {
+            size_t copied{};
+            try
             {
-                return convert<reference>(make_index_sequence<sizeof...(Members)>{});
+                ((copy_column(get<I>(_from), _count, get<I>(_to)), ++copied), ...);
             }
-
-            template<MembersDesc MemberIndex>
-            const auto& value()
+            catch (...)
             {
-                return *get<getIndex<MemberIndex>()>(m_ptr);
+                ((I < copied ? (void)std::destroy_n(get<I>(_to), _count) : void()), ...);
+                throw;
             }
+        }
 
-            partial_const_iterator& operator++()
+        template<typename... Columns, size_t... I>
+        void move_rows(const tuple<Columns*...>& _from, size_t _count, const tuple<Columns*...>& _to, index_sequence<I...>)
+        {
+            size_t moved{};
+            try
             {
-                apply([](auto*&... _obj) { (++_obj, ...); }, m_ptr);
-                return *this;
+                ((move_column(get<I>(_from), _count, get<I>(_to)), ++moved), ...);
             }
-
-            partial_const_iterator operator++(int)
+            catch (...)
             {
-                partial_const_iterator ret = *this;
-                apply([](auto*&... _obj) { (_obj++, ...); }, m_ptr);
-                return ret;
+                ((I < moved ? (void)std::destroy_n(get<I>(_to), _count) : void()), ...);
+                throw;
             }
+        }
 
-            partial_const_iterator& operator--()
+        // Copy constructs the elements of _from at the given indices into the uninitialized _to
+        template<typename T>
+        void gather_column(const T* _from, const size_t* _indices, size_t _count, T* _to)
+        {
+            size_t constructed{};
+            try
             {
-                apply([](auto*&... _obj) { (--_obj, ...); }, m_ptr);
-                return *this;
+                for (; constructed < _count; ++constructed)
+                    ::new (static_cast<void*>(_to + constructed)) T(_from[_indices[constructed]]);
             }
-
-            partial_const_iterator operator--(int)
+            catch (...)
             {
-                partial_const_iterator ret = *this;
-                apply([](auto*&... _obj) { (_obj--, ...); }, m_ptr);
-                return ret;
+                std::destroy_n(_to, constructed);
+                throw;
             }
+        }
 
-            difference_type operator-(const partial_const_iterator& _other) const
+        template<typename... Columns, size_t... I>
+        void gather_rows(const tuple<Columns*...>& _from, const size_t* _indices, size_t _count, const tuple<Columns*...>& _to, index_sequence<I...>)
+        {
+            size_t gathered{};
+            try
             {
-                return get<0>(m_ptr) - get<0>(_other.m_ptr);
+                ((gather_column(get<I>(_from), _indices, _count, get<I>(_to)), ++gathered), ...);
             }
-
-            bool operator==(const partial_const_iterator& _other) const
+            catch (...)
             {
-                return m_ptr == _other.m_ptr;
+                ((I < gathered ? (void)std::destroy_n(get<I>(_to), _count) : void()), ...);
+                throw;
             }
+        }
 
-            bool operator!=(const partial_const_iterator& _other) const
+        // Number of bits set, written so that compilers emit a population count instruction when available
+        inline size_t popcount(uint64_t _word)
+        {
+            _word -= (_word >> 1) & 0x5555555555555555ull;
+            _word = (_word & 0x3333333333333333ull) + ((_word >> 2) & 0x3333333333333333ull);
+            _word = (_word + (_word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+            return static_cast<size_t>((_word * 0x0101010101010101ull) >> 56);
+        }
+
+        // Index of the lowest bit set, _word being non zero
+        inline size_t countr_zero(uint64_t _word)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<size_t>(__builtin_ctzll(_word));
+#elif defined(_MSC_VER) && defined(_WIN64)
+            unsigned long index{};
+            _BitScanForward64(&index, _word);
+            return index;
+#else
+            size_t index{};
+            while ((_word & 1) == 0)
             {
-                return m_ptr != _other.m_ptr;
+                _word >>= 1;
+                ++index;
             }
+            return index;
+#endif
+        }
 
-        protected:
-            static constexpr array<size_t, sizeof...(Members)> ms_mapping{ static_cast<size_t>(Members)... };
+        template<typename T>
+        using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
 
-            pointer m_ptr{};
+        // Size of a tuple-like type, 0 for other types
+        template<typename T, typename = void>
+        constexpr size_t tuple_size_v = 0;
 
-            template<typename... Args>
-            partial_const_iterator(Args... _args)
-                : m_ptr{ make_tuple(_args...) }
-            {
-            }
+        template<typename T>
+        constexpr size_t tuple_size_v<T, std::void_t<decltype(std::tuple_size<T>::value)>> = std::tuple_size<T>::value;
 
-            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
+        // Containers of indices stored contiguously as size_t, used without a copy
+        template<typename T, typename = void>
+        constexpr bool is_contiguous_order_v = false;
 
-            template<MembersDesc MemberIndex, size_t Index = 0>
-            static constexpr size_t getIndex()
+        template<typename T>
+        constexpr bool is_contiguous_order_v<T, std::void_t<decltype(std::declval<const T&>().data())>> = std::is_same_v<decltype(std::declval<const T&>().data()), const size_t*>;
+
+        // Radix sort support: arithmetic and enum keys are mapped to unsigned integers preserving their order
+        template<typename T>
+        constexpr bool is_radix_sortable_v = (std::is_arithmetic_v<T> || std::is_enum_v<T>) && sizeof(T) <= sizeof(uint64_t) && !std::is_same_v<T, long double>;
+
+        template<typename T>
+        auto radix_key(T _value)
+        {
+            if constexpr (std::is_enum_v<T>)
             {
-                if constexpr (ms_mapping[Index] == static_cast<size_t>(MemberIndex))
-                    return Index;
-                else
-                    return getIndex<MemberIndex, Index + 1>();
+                return radix_key(static_cast<std::underlying_type_t<T>>(_value));
             }
-
-            template<typename R, size_t... I>
-            R convert(index_sequence<I...>) const
+            else if constexpr (std::is_same_v<T, bool>)
             {
-                return { (*get<I>(this->m_ptr))... };
+                return static_cast<uint8_t>(_value);
             }
-        };
-
-        template<MembersDesc... Members>
-        class partial_iterator : public partial_const_iterator<Members...>
-        {
-            using base_iterator = partial_const_iterator<Members...>;
-
-            // Not sure why calling base_iterator::getIndex() doesn't work
-            template<MembersDesc MemberIndex, size_t Index = 0>
-            static constexpr size_t getIndex()
+            else if constexpr (std::is_integral_v<T>)
             {
-                if constexpr (base_iterator::ms_mapping[Index] == static_cast<size_t>(MemberIndex))
-                    return Index;
+                using key_type = std::make_unsigned_t<T>;
+                if constexpr (std::is_signed_v<T>)
+                    return static_cast<key_type>(static_cast<key_type>(_value) ^ (key_type{ 1 } << (sizeof(T) * 8 - 1)));
                 else
-                    return getIndex<MemberIndex, Index + 1>();
+                    return static_cast<key_type>(_value);
             }
-
-        public:
-            using pointer = tuple<tuple_element_t<static_cast<size_t>(Members), value_list>*...>;
-            using iterator_category = random_access_iterator_tag;
-            using difference_type = ptrdiff_t;
-            using reference = partial_ref_list<Members...>;
-            using value_type = void;
-
-            reference operator*() const
+            else
             {
-                return convert<reference>(make_index_sequence<sizeof...(Members)>{});
+                using key_type = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+                static_assert(sizeof(T) == sizeof(key_type), "Unsupported floating point type");
+
+                // -0 and +0 compare equal: both take the key of +0, so that the sort stays stable
+                const T value{ _value == T{} ? T{} : _value };
+                key_type bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                constexpr key_type signBit{ key_type{ 1 } << (sizeof(key_type) * 8 - 1) };
+                return static_cast<key_type>((bits & signBit) != 0 ? ~bits : bits | signBit);
             }
+        }
 
-            template<MembersDesc MemberIndex>
-            auto& value()
+        // Returns the stable order of the given keys: the first element is the index of the smallest key, and so on.
+        // LSD radix sort on 8 bits digits, skipping the digits shared by all the keys.
+        template<typename Keys>
+        buffer<size_t> radix_order(Keys _keys, size_t _count)
+        {
+            using key_type = decltype(radix_key(_keys[0]));
+            constexpr size_t digits{ sizeof(key_type) };
+            constexpr size_t small_count{ 64 };
+
+            buffer<size_t> order(_count);
+            for (size_t i = 0; i < _count; ++i)
+                order[i] = i;
+
+            if (_count < small_count)
             {
-                return *const_cast<tuple_element_t<getIndex<MemberIndex>(), pointer>>(get<getIndex<MemberIndex>()>(this->m_ptr));
+                std::stable_sort(order.begin(), order.end(), [_keys](size_t _lhs, size_t _rhs) { return radix_key(_keys[_lhs]) < radix_key(_keys[_rhs]); });
+                return order;
             }
 
-            partial_iterator& operator++()
+            buffer<key_type> keys(_count);
+            buffer<array<size_t, 256>> histograms(digits);
+            for (size_t i = 0; i < _count; ++i)
             {
-                base_iterator::operator++();
-                return *this;
+                keys[i] = radix_key(_keys[i]);
+                for (size_t digit = 0; digit < digits; ++digit)
+                    ++histograms[digit][(keys[i] >> (digit * 8)) & 0xFF];
             }
 
-            partial_iterator operator++(int)
+            buffer<key_type> keysTmp(_count);
+            buffer<size_t> orderTmp(_count);
+            for (size_t digit = 0; digit < digits; ++digit)
             {
-                partial_iterator ret = *this;
-                base_iterator::operator++();
+                array<size_t, 256>& histogram{ histograms[digit] };
+                const size_t shift{ digit * 8 };
+                if (histogram[(keys[0] >> shift) & 0xFF] == _count)
+                    continue;
+
+                size_t offset{};
+                for (size_t& count : histogram)
+                {
+                    const size_t bucketSize{ count };
+                    count = offset;
+                    offset += bucketSize;
+                }
+
+                for (size_t i = 0; i < _count; ++i)
+                {
+                    const size_t position{ histogram[(keys[i] >> shift) & 0xFF]++ };
+                    keysTmp[position] = keys[i];
+                    orderTmp[position] = order[i];
+                }
+                keys.swap(keysTmp);
+                order.swap(orderTmp);
+            }
+            return order;
+        }
+
+        // Reorders a column in place, so that _column[i] receives the former _column[_order[i]].
+        // Each cycle of the permutation is followed once, with a single temporary per cycle.
+        template<typename T>
+        void permute_column(T* _column, size_t _count, const size_t* _order, uint64_t* _visited)
+        {
+            std::fill_n(_visited, (_count + 63) / 64, uint64_t{});
+            for (size_t start = 0; start < _count; ++start)
+            {
+                if ((_visited[start / 64] >> (start % 64)) & 1 || _order[start] == start)
+                    continue;
+
+                T tmp(std::move(_column[start]));
+                size_t current{ start };
+                while (true)
+                {
+                    _visited[current / 64] |= uint64_t{ 1 } << (current % 64);
+                    const size_t next{ _order[current] };
+                    if (next == start)
+                    {
+                        _column[current] = std::move(tmp);
+                        break;
+                    }
+                    _column[current] = std::move(_column[next]);
+                    current = next;
+                }
+            }
+        }
+    }
+
+    // Members stored together: in the Types of a vector_base, group<A, B> declares two members, A and B,
+    // interleaved in a single column, so that iterating on both members reads a single stream of memory.
+    template<typename... Types>
+    struct group
+    {
+        static_assert(sizeof...(Types) >= 2, "A group needs at least two members");
+    };
+
+    namespace detail
+    {
+        // Row of a group column. Unlike std::tuple, it is trivially copyable when all its members are,
+        // so the group columns keep the memcpy and realloc paths of the other columns.
+        template<typename... Types>
+        struct group_storage;
+
+        template<typename T>
+        struct group_storage<T>
+        {
+            T value;
+
+            group_storage() = default;
+
+            template<typename Tuple, typename = std::enable_if_t<tuple_size_v<remove_cvref_t<Tuple>> == 1>>
+            explicit group_storage(Tuple&& _values)
+                : value(get<0>(std::forward<Tuple>(_values)))
+            {
+            }
+        };
+
+        template<typename T, typename... Rest>
+        struct group_storage<T, Rest...>
+        {
+            T value;
+            group_storage<Rest...> rest;
+
+            group_storage() = default;
+
+            // Constructs each member from the matching element of a tuple of arguments
+            template<typename Tuple, typename = std::enable_if_t<tuple_size_v<remove_cvref_t<Tuple>> == 1 + sizeof...(Rest)>>
+            explicit group_storage(Tuple&& _values)
+                : group_storage{ std::forward<Tuple>(_values), make_index_sequence<sizeof...(Rest)>{} }
+            {
+            }
+
+        private:
+            template<typename Tuple, size_t... I>
+            group_storage(Tuple&& _values, index_sequence<I...>)
+                : value(get<0>(std::forward<Tuple>(_values)))
+                , rest(forward_as_tuple(get<I + 1>(std::forward<Tuple>(_values))...))
+            {
+            }
+        };
+
+        template<size_t Field, typename Group>
+        auto& field(Group& _group)
+        {
+            if constexpr (Field == 0)
+                return _group.value;
+            else
+                return field<Field - 1>(_group.rest);
+        }
+
+        // Pointer on a grouped member: it walks the rows of the group column, and selects the member Field in each one
+        template<typename Column, size_t Field>
+        class field_pointer
+        {
+        public:
+            using column_pointer = Column*;
+            using element_type = std::remove_reference_t<decltype(field<Field>(std::declval<Column&>()))>;
+
+            field_pointer() = default;
+
+            explicit field_pointer(Column* _row)
+                : m_row{ _row }
+            {
+            }
+
+            // Conversion from a pointer on mutable members to a pointer on const members
+            template<typename Other, typename = std::enable_if_t<is_same_v<const Other, Column> && !is_same_v<Other, Column>>>
+            field_pointer(const field_pointer<Other, Field>& _other)
+                : m_row{ _other.column() }
+            {
+            }
+
+            Column* column() const
+            {
+                return m_row;
+            }
+
+            element_type& operator*() const
+            {
+                return field<Field>(*m_row);
+            }
+
+            element_type* operator->() const
+            {
+                return &field<Field>(*m_row);
+            }
+
+            element_type& operator[](ptrdiff_t _offset) const
+            {
+                return field<Field>(m_row[_offset]);
+            }
+
+            field_pointer& operator++()
+            {
+                ++m_row;
+                return *this;
+            }
+
+            field_pointer operator++(int)
+            {
+                field_pointer ret = *this;
+                ++m_row;
                 return ret;
             }
 
-            partial_iterator& operator--()
+            field_pointer& operator--()
             {
-                base_iterator::operator--();
+                --m_row;
                 return *this;
             }
 
-            partial_iterator operator--(int)
+            field_pointer operator--(int)
             {
-                partial_iterator ret = *this;
-                base_iterator::operator--();
+                field_pointer ret = *this;
+                --m_row;
                 return ret;
             }
 
+            field_pointer& operator+=(ptrdiff_t _offset)
+            {
+                m_row += _offset;
+                return *this;
+            }
+
+            field_pointer& operator-=(ptrdiff_t _offset)
+            {
+                m_row -= _offset;
+                return *this;
+            }
+
+            friend field_pointer operator+(field_pointer _ptr, ptrdiff_t _offset)
+            {
+                return _ptr += _offset;
+            }
+
+            friend field_pointer operator-(field_pointer _ptr, ptrdiff_t _offset)
+            {
+                return _ptr -= _offset;
+            }
+
+            friend ptrdiff_t operator-(const field_pointer& _lhs, const field_pointer& _rhs)
+            {
+                return _lhs.m_row - _rhs.m_row;
+            }
+
+            friend bool operator==(const field_pointer& _lhs, const field_pointer& _rhs)
+            {
+                return _lhs.m_row == _rhs.m_row;
+            }
+
+            friend bool operator!=(const field_pointer& _lhs, const field_pointer& _rhs)
+            {
+                return _lhs.m_row != _rhs.m_row;
+            }
+
+            friend bool operator<(const field_pointer& _lhs, const field_pointer& _rhs)
+            {
+                return _lhs.m_row < _rhs.m_row;
+            }
+
         private:
-            template<typename R, size_t... I>
-            R convert(index_sequence<I...>) const
+            Column* m_row{};
+        };
+
+        // const_cast of a member pointer, raw pointer or field_pointer
+        template<typename To, typename From>
+        To const_pointer_cast(From _ptr)
+        {
+            if constexpr (std::is_pointer_v<To>)
+                return const_cast<To>(_ptr);
+            else
+                return To{ const_cast<typename To::column_pointer>(_ptr.column()) };
+        }
+
+        // A type is a column of its own, a group stores all its members in a single column
+        template<typename T>
+        struct group_traits
+        {
+            using column_type = T;
+            using members = tuple<T>;
+        };
+
+        template<typename... Types>
+        struct group_traits<group<Types...>>
+        {
+            using column_type = group_storage<Types...>;
+            using members = tuple<Types...>;
+        };
+
+        // Column of each member, or position of each member in its column when _field is true
+        template<size_t MembersCount, size_t ColumnsCount>
+        constexpr array<size_t, MembersCount> member_columns(const array<size_t, ColumnsCount>& _sizes, bool _field)
+        {
+            array<size_t, MembersCount> result{};
+            size_t member{};
+            for (size_t column = 0; column < ColumnsCount; ++column)
             {
-                return { (*const_cast<tuple_element_t<I, pointer>>(get<I>(this->m_ptr)))... };
+                for (size_t position = 0; position < _sizes[column]; ++position, ++member)
+                    result[member] = _field ? position : column;
             }
+            return result;
+        }
 
-            using base_iterator::partial_const_iterator;
-            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
+        template<size_t ColumnsCount>
+        constexpr array<size_t, ColumnsCount> first_members(const array<size_t, ColumnsCount>& _sizes)
+        {
+            array<size_t, ColumnsCount> result{};
+            size_t member{};
+            for (size_t column = 0; column < ColumnsCount; ++column)
+            {
+                result[column] = member;
+                member += _sizes[column];
+            }
+            return result;
+        }
+
+        // Members and columns of a vector_base: the members are the Types, the groups being expanded,
+        // and each type or group is a column
+        template<typename... Types>
+        struct member_layout
+        {
+            using members = decltype(std::tuple_cat(std::declval<typename group_traits<Types>::members>()...));
+            using columns = tuple<typename group_traits<Types>::column_type...>;
+            using column_pointers = tuple<typename group_traits<Types>::column_type*...>;
+            using block = block_layout<typename group_traits<Types>::column_type...>;
+
+            static constexpr size_t members_count{ std::tuple_size_v<members> };
+            static constexpr size_t columns_count{ sizeof...(Types) };
+            static constexpr bool has_groups{ members_count != columns_count };
+            static constexpr bool trivially_copyable{ (std::is_trivially_copyable_v<typename group_traits<Types>::column_type> && ...) };
+
+            // Number of members, column and position in the column of each member, first member of each column
+            static constexpr array<size_t, columns_count> column_size{ std::tuple_size_v<typename group_traits<Types>::members>... };
+            static constexpr array<size_t, members_count> column_of{ member_columns<members_count>(column_size, false) };
+            static constexpr array<size_t, members_count> field_of{ member_columns<members_count>(column_size, true) };
+            static constexpr array<size_t, columns_count> first_member{ first_members(column_size) };
+
+            template<size_t I>
+            using member_type = tuple_element_t<I, members>;
+
+            template<size_t I>
+            static constexpr bool is_grouped{ column_size[column_of[I]] > 1 };
+
+            // Pointer on a member, Element being the member type or its const version
+            template<size_t I, typename Element = member_type<I>>
+            using pointer = std::conditional_t<is_grouped<I>,
+                field_pointer<std::conditional_t<std::is_const_v<Element>, const tuple_element_t<column_of[I], columns>, tuple_element_t<column_of[I], columns>>, field_of[I]>,
+                Element*>;
+
+            template<size_t I>
+            static pointer<I> address(const column_pointers& _columns, ptrdiff_t _row)
+            {
+                if constexpr (is_grouped<I>)
+                    return pointer<I>{ get<column_of[I]>(_columns) + _row };
+                else
+                    return get<column_of[I]>(_columns) + _row;
+            }
         };
+    }
 
-        vector_base() = default;
-        vector_base(const vector_base&) = default;
-        vector_base(vector_base&&) = default;
-        ~vector_base() = default;
-        vector_base& operator=(const vector_base&) = default;
-        vector_base& operator=(vector_base&&) = default;
+    // Non owning view of contiguous elements, similar to std::span
+    template<typename T>
+    class span
+    {
+    public:
+        using element_type = T;
+        using value_type = remove_const_t<T>;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+        using iterator = T*;
 
-        explicit vector_base(Allocator _allocator)
-            : m_soa{ container<Types, allocator_wrapper<Types>>{ std::move(_allocator) }... }
+        span() = default;
+
+        span(T* _data, size_type _size)
+            : m_data{ _data }
+            , m_size{ _size }
         {
         }
 
-        explicit vector_base(size_type _count, Allocator _allocator = Allocator())
-            : m_soa{ container<Types, allocator_wrapper<Types>>{ _count, std::move(_allocator) }... }
+        // Conversion from a span of mutable elements to a span of const elements
+        template<typename U, typename = std::enable_if_t<is_same_v<const U, T> && !is_same_v<U, T>>>
+        span(const span<U>& _other)
+            : span{ _other.data(), _other.size() }
         {
         }
 
-        template<typename... Args>
-        vector_base(size_type _count, Args&&... _args)
+#if __cplusplus >= 202002L
+        operator std::span<T>() const
         {
-            resize(_count, _args...);
+            return { m_data, m_size };
         }
+#endif
 
-        vector_base(size_type _count, const const_reference_list& _value, Allocator _allocator = Allocator())
-            : vector_base{ _allocator }
+        T* data() const
         {
-            resize(_count, _value);
+            return m_data;
         }
 
         size_type size() const
         {
-            return get<0>(m_soa).size();
+            return m_size;
         }
 
-        size_type capacity() const
+        size_type size_bytes() const
         {
-            return get<0>(m_soa).capacity();
+            return m_size * sizeof(T);
         }
 
         bool empty() const
         {
-            return get<0>(m_soa).empty();
+            return m_size == 0;
         }
 
-        iterator begin()
+        T* begin() const
         {
-            return begin_internal(make_index_sequence<members_count>{});
+            return m_data;
         }
 
-        const_iterator begin() const
+        T* end() const
         {
-            return begin_internal(make_index_sequence<members_count>{});
+            return m_data + m_size;
         }
 
-        const_iterator cbegin() const
+        T& operator[](size_type _index) const
         {
-            return begin_internal(make_index_sequence<members_count>{});
+            return m_data[_index];
         }
 
-        iterator end()
+        T& front() const
         {
-            return end_internal(make_index_sequence<members_count>{});
+            return m_data[0];
         }
 
-        const_iterator end() const
+        T& back() const
         {
-            return end_internal(make_index_sequence<members_count>{});
+            return m_data[m_size - 1];
         }
 
-        const_iterator cend() const
+        span first(size_type _count) const
         {
-            return end_internal(make_index_sequence<members_count>{});
+            return { m_data, _count };
         }
 
-        template<MembersDesc... Members>
-        partial_iterator<Members...> begin()
+        span last(size_type _count) const
         {
-            return { get<static_cast<size_t>(Members)>(m_soa).data()... };
+            return { m_data + m_size - _count, _count };
         }
 
-        template<MembersDesc... Members>
-        partial_iterator<Members...> end()
+        span subspan(size_type _offset, size_type _count) const
+        {
+            return { m_data + _offset, _count };
+        }
+
+    private:
+        T* m_data{};
+        size_type m_size{};
+    };
+
+    // Reference on the members of a row, returned when dereferencing the iterators.
+    // It is a tuple of references, so it can be used as such, but assigning or swapping it
+    // applies to the referenced members: standard algorithms can then permute rows through the iterators.
+    // Refs can also be rvalue references, to move the members (see iter_move).
+    template<typename... Refs>
+    class row_reference : public tuple<Refs...>
+    {
+        using base = tuple<Refs...>;
+
+        template<typename Other>
+        static constexpr bool is_assignable_from = !is_same_v<detail::remove_cvref_t<Other>, row_reference> && detail::tuple_size_v<detail::remove_cvref_t<Other>> == sizeof...(Refs);
+
+    public:
+        using value_type = tuple<detail::remove_cvref_t<Refs>...>;
+
+        row_reference(Refs... _refs)
+            : base{ std::forward<Refs>(_refs)... }
+        {
+        }
+
+        template<typename... Others, typename = std::enable_if_t<std::is_constructible_v<base, const tuple<Others...>&>>>
+        row_reference(const tuple<Others...>& _other)
+            : base{ _other }
+        {
+        }
+
+        row_reference(const row_reference&) = default;
+
+        row_reference& operator=(const row_reference& _other)
+        {
+            assign(_other, make_index_sequence<sizeof...(Refs)>{});
+            return *this;
+        }
+
+        const row_reference& operator=(const row_reference& _other) const
+        {
+            assign(_other, make_index_sequence<sizeof...(Refs)>{});
+            return *this;
+        }
+
+        template<typename Other, typename = std::enable_if_t<is_assignable_from<Other>>>
+        row_reference& operator=(Other&& _other)
+        {
+            assign(std::forward<Other>(_other), make_index_sequence<sizeof...(Refs)>{});
+            return *this;
+        }
+
+        template<typename Other, typename = std::enable_if_t<is_assignable_from<Other>>>
+        const row_reference& operator=(Other&& _other) const
         {
-            const size_type size{ this->size() };
-            return { get<static_cast<size_t>(Members)>(m_soa).data() + size... };
+            assign(std::forward<Other>(_other), make_index_sequence<sizeof...(Refs)>{});
+            return *this;
+        }
+
+        friend void swap(row_reference _lhs, row_reference _rhs)
+        {
+            swap_internal(_lhs, _rhs, make_index_sequence<sizeof...(Refs)>{});
+        }
+
+        template<size_t Index>
+        tuple_element_t<Index, base> get() const
+        {
+            return std::get<Index>(static_cast<const base&>(*this));
+        }
+
+    private:
+        template<typename Other, size_t... I>
+        void assign(Other&& _other, index_sequence<I...>) const
+        {
+            ((std::get<I>(static_cast<const base&>(*this)) = std::get<I>(std::forward<Other>(_other))), ...);
+        }
+
+        template<size_t... I>
+        static void swap_internal(const row_reference& _lhs, const row_reference& _rhs, index_sequence<I...>)
+        {
+            using std::swap;
+            (swap(std::get<I>(static_cast<const base&>(_lhs)), std::get<I>(static_cast<const base&>(_rhs))), ...);
+        }
+    };
+
+    namespace detail
+    {
+        // Random access iterator made of a pointer to the column table of a container, and a row index.
+        // Advancing it is a single addition whatever the number of members, and the column addresses
+        // are loop invariant. It stays valid when the container reallocates, as long as the index is valid.
+        // Addressing provides the table type, the element types, and the address of an element from the table.
+        template<typename Addressing, bool IsConst, typename MembersDesc, MembersDesc... Members>
+        class indexed_iterator
+        {
+            using table = typename Addressing::table;
+
+            template<MembersDesc Member>
+            using element_type = typename Addressing::template element_type<static_cast<size_t>(Member)>;
+
+            template<MembersDesc Member>
+            using element_reference = std::conditional_t<IsConst, const element_type<Member>&, element_type<Member>&>;
+
+            static constexpr array<size_t, sizeof...(Members)> ms_mapping{ static_cast<size_t>(Members)... };
+
+        public:
+            using iterator_category = random_access_iterator_tag;
+            using difference_type = ptrdiff_t;
+            using reference = row_reference<element_reference<Members>...>;
+            using value_type = tuple<element_type<Members>...>;
+            using pointer = void;
+
+            indexed_iterator() = default;
+
+            indexed_iterator(const table* _table, difference_type _index)
+                : m_table{ _table }
+                , m_index{ _index }
+            {
+            }
+
+            // Conversion from the mutable iterator to the const one
+            template<bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+            indexed_iterator(const indexed_iterator<Addressing, OtherConst, MembersDesc, Members...>& _other)
+                : m_table{ _other.m_table }
+                , m_index{ _other.m_index }
+            {
+            }
+
+            reference operator*() const
+            {
+                return { *Addressing::template address<static_cast<size_t>(Members)>(*m_table, m_index)... };
+            }
+
+            reference operator[](difference_type _offset) const
+            {
+                return *(*this + _offset);
+            }
+
+            // Allows algorithms using std::ranges::iter_move to move the members instead of copying them
+            friend auto iter_move(const indexed_iterator& _it)
+            {
+                if constexpr (IsConst)
+                    return *_it;
+                else
+                    return row_reference<element_type<Members>&&...>{ std::move(*Addressing::template address<static_cast<size_t>(Members)>(*_it.m_table, _it.m_index))... };
+            }
+
+            template<MembersDesc MemberIndex>
+            element_reference<MemberIndex> value() const
+            {
+                static_assert(((MemberIndex == Members) || ...), "The member is not part of the iterator");
+                return *Addressing::template address<static_cast<size_t>(MemberIndex)>(*m_table, m_index);
+            }
+
+            difference_type index() const
+            {
+                return m_index;
+            }
+
+            indexed_iterator& operator++()
+            {
+                ++m_index;
+                return *this;
+            }
+
+            indexed_iterator operator++(int)
+            {
+                indexed_iterator ret = *this;
+                ++m_index;
+                return ret;
+            }
+
+            indexed_iterator& operator--()
+            {
+                --m_index;
+                return *this;
+            }
+
+            indexed_iterator operator--(int)
+            {
+                indexed_iterator ret = *this;
+                --m_index;
+                return ret;
+            }
+
+            indexed_iterator& operator+=(difference_type _offset)
+            {
+                m_index += _offset;
+                return *this;
+            }
+
+            indexed_iterator& operator-=(difference_type _offset)
+            {
+                m_index -= _offset;
+                return *this;
+            }
+
+            friend indexed_iterator operator+(indexed_iterator _it, difference_type _offset)
+            {
+                return _it += _offset;
+            }
+
+            friend indexed_iterator operator+(difference_type _offset, indexed_iterator _it)
+            {
+                return _it += _offset;
+            }
+
+            friend indexed_iterator operator-(indexed_iterator _it, difference_type _offset)
+            {
+                return _it -= _offset;
+            }
+
+            friend difference_type operator-(const indexed_iterator& _lhs, const indexed_iterator& _rhs)
+            {
+                return _lhs.m_index - _rhs.m_index;
+            }
+
+            friend bool operator==(const indexed_iterator& _lhs, const indexed_iterator& _rhs)
+            {
+                return _lhs.m_index == _rhs.m_index;
+            }
+
+            friend bool operator!=(const indexed_iterator& _lhs, const indexed_iterator& _rhs)
+            {
+                return _lhs.m_index != _rhs.m_index;
+            }
+
+            friend bool operator<(const indexed_iterator& _lhs, const indexed_iterator& _rhs)
+            {
+                return _lhs.m_index < _rhs.m_index;
+            }
+
+            friend bool operator>(const indexed_iterator& _lhs, const indexed_iterator& _rhs)
+            {
+                return _lhs.m_index > _rhs.m_index;
+            }
+
+            friend bool operator<=(const indexed_iterator& _lhs, const indexed_iterator& _rhs)
+            {
+                return _lhs.m_index <= _rhs.m_index;
+            }
+
+            friend bool operator>=(const indexed_iterator& _lhs, const indexed_iterator& _rhs)
+            {
+                return _lhs.m_index >= _rhs.m_index;
+            }
+
+        private:
+            const table* m_table{};
+            difference_type m_index{};
+
+            template<typename, bool, typename T, T...>
+            friend class indexed_iterator;
+        };
+    }
+
+    // Allocation and relocation counters of a container, per column (a group of members being a single column)
+    // and in total. They are only maintained when SOA_STATS is defined, see vector_base::stats().
+    // SOA_STATS changes the layout of vector_base: all the translation units of a program must agree on it.
+    template<size_t ColumnsCount>
+    struct container_stats
+    {
+        struct column
+        {
+            size_t bytes_allocated{};
+            size_t moved{};
+            size_t copied{};
+        };
+
+        size_t allocations{};
+        size_t frees{};
+        size_t bytes_allocated{};
+        size_t growths{};
+        array<column, ColumnsCount> columns{};
+
+        // Elements moved or copied by insert, erase, assignment and growth, in all the columns
+        size_t moved() const
+        {
+            size_t count{};
+            for (const column& stats : columns)
+                count += stats.moved;
+            return count;
+        }
+
+        size_t copied() const
+        {
+            size_t count{};
+            for (const column& stats : columns)
+                count += stats.copied;
+            return count;
+        }
+    };
+
+    // Execution of the algorithms on the calling thread
+    struct sequential_policy
+    {
+    };
+
+    // Execution of the algorithms by several threads: the hardware threads when threads is 0,
+    // the algorithms splitting rows giving at least min_rows rows to each thread
+    struct parallel_policy
+    {
+        size_t threads{};
+        size_t min_rows{ size_t{ 1 } << 16 };
+    };
+
+    inline constexpr sequential_policy seq{};
+    inline constexpr parallel_policy par{};
+
+    namespace detail
+    {
+        inline size_t policy_threads(const parallel_policy& _policy)
+        {
+            if (_policy.threads != 0)
+                return _policy.threads;
+
+            const size_t hardware{ std::thread::hardware_concurrency() };
+            return hardware != 0 ? hardware : 1;
+        }
+
+        // Runs _task(i) for each i in [0, _tasks), on up to _threads threads including the calling one, each thread taking
+        // the next task when it is done with its current one. The first exception thrown by a task is rethrown once all the threads are done.
+        template<typename Task>
+        void run_parallel(size_t _tasks, size_t _threads, Task&& _task)
+        {
+            std::atomic<size_t> next{};
+            std::exception_ptr error;
+            std::atomic<bool> failed{};
+            const auto work = [&]() {
+                for (size_t task = next++; task < _tasks; task = next++)
+                {
+                    try
+                    {
+                        _task(task);
+                    }
+                    catch (...)
+                    {
+                        if (!failed.exchange(true))
+                            error = std::current_exception();
+                    }
+                }
+            };
+
+            const size_t threads{ _threads < _tasks ? _threads : _tasks };
+            buffer<std::thread> workers;
+            workers.reserve(threads > 1 ? threads - 1 : 0);
+            try
+            {
+                for (size_t thread = 1; thread < threads; ++thread)
+                    workers.emplace_back(work);
+            }
+            catch (...)
+            {
+                // The tasks are still run by the started threads and this one
+                work();
+                for (std::thread& worker : workers)
+                    worker.join();
+                throw;
+            }
+            work();
+            for (std::thread& worker : workers)
+                worker.join();
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+    }
+
+    // Indices of the rows selected by vector_base::select, in increasing order
+    class selection
+    {
+    public:
+        using size_type = size_t;
+
+        selection() = default;
+
+        explicit selection(buffer<size_t> _indices)
+            : m_indices{ std::move(_indices) }
+        {
+        }
+
+        size_type size() const
+        {
+            return m_indices.size();
+        }
+
+        bool empty() const
+        {
+            return m_indices.empty();
+        }
+
+        size_t operator[](size_type _index) const
+        {
+            return m_indices[_index];
+        }
+
+        const size_t* data() const
+        {
+            return m_indices.data();
+        }
+
+        const size_t* begin() const
+        {
+            return m_indices.data();
+        }
+
+        const size_t* end() const
+        {
+            return m_indices.data() + m_indices.size();
+        }
+
+    private:
+        buffer<size_t> m_indices;
+    };
+
+    // One bit per row of a table, set for the rows selected by vector_base::select_mask.
+    // The masks of a table are combined with &, | and ~, and converted to a selection.
+    class bitmask
+    {
+    public:
+        using size_type = size_t;
+
+        bitmask() = default;
+
+        explicit bitmask(size_type _size)
+            : m_words((_size + 63) / 64)
+            , m_size{ _size }
+        {
+        }
+
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        bool test(size_type _index) const
+        {
+            return (m_words[_index / 64] >> (_index % 64)) & 1;
+        }
+
+        void set(size_type _index, bool _value = true)
+        {
+            uint64_t& word{ m_words[_index / 64] };
+            word = (word & ~(uint64_t{ 1 } << (_index % 64))) | (static_cast<uint64_t>(_value) << (_index % 64));
+        }
+
+        // Number of bits set
+        size_type count() const
+        {
+            size_type bits{};
+            for (uint64_t word : m_words)
+                bits += detail::popcount(word);
+            return bits;
+        }
+
+        uint64_t* words()
+        {
+            return m_words.data();
+        }
+
+        const uint64_t* words() const
+        {
+            return m_words.data();
+        }
+
+        size_type word_count() const
+        {
+            return m_words.size();
+        }
+
+        bitmask& operator&=(const bitmask& _other)
+        {
+            check_size(_other);
+            for (size_type i = 0; i < m_words.size(); ++i)
+                m_words[i] &= _other.m_words[i];
+            return *this;
+        }
+
+        bitmask& operator|=(const bitmask& _other)
+        {
+            check_size(_other);
+            for (size_type i = 0; i < m_words.size(); ++i)
+                m_words[i] |= _other.m_words[i];
+            return *this;
+        }
+
+        friend bitmask operator&(bitmask _lhs, const bitmask& _rhs)
+        {
+            return _lhs &= _rhs;
+        }
+
+        friend bitmask operator|(bitmask _lhs, const bitmask& _rhs)
+        {
+            return _lhs |= _rhs;
+        }
+
+        // The bits beyond the size stay cleared
+        friend bitmask operator~(bitmask _mask)
+        {
+            for (uint64_t& word : _mask.m_words)
+                word = ~word;
+            if (_mask.m_size % 64 != 0)
+                _mask.m_words.back() &= (uint64_t{ 1 } << (_mask.m_size % 64)) - 1;
+            return _mask;
+        }
+
+        // Indices of the bits set, compacted without branches
+        selection to_selection() const
+        {
+            buffer<size_t> indices(count());
+            size_t* out{ indices.data() };
+            size_t selected{};
+            for (size_type i = 0; i < m_words.size(); ++i)
+            {
+                const uint64_t word{ m_words[i] };
+                if (word == 0)
+                    continue;
+
+                // The last index written past the selected ones is overwritten or dropped
+                for (size_type bit = 0; bit < 64 && selected < indices.size(); ++bit)
+                {
+                    out[selected] = i * 64 + bit;
+                    selected += (word >> bit) & 1;
+                }
+            }
+            return selection{ std::move(indices) };
+        }
+
+    private:
+        // Masks are combined row by row: they must come from tables of the same size
+        void check_size(const bitmask& _other) const
+        {
+            if (_other.m_size != m_size)
+                throw std::invalid_argument{ "soa::bitmask: the masks have different sizes" };
+        }
+
+        buffer<uint64_t> m_words;
+        size_type m_size{};
+    };
+
+    template <typename MembersDesc, typename Allocator, typename... Types>
+    class vector_base
+    {
+        // Each type is a column, except the groups (see soa::group), whose members share a single column
+        using members_layout = detail::member_layout<Types...>;
+
+        // Pointers on the members: raw pointers, or detail::field_pointer for the grouped members
+        template<MembersDesc Member>
+        using member_pointer = typename members_layout::template pointer<static_cast<size_t>(Member)>;
+
+        template<MembersDesc Member>
+        using member_const_pointer = typename members_layout::template pointer<static_cast<size_t>(Member), const typename members_layout::template member_type<static_cast<size_t>(Member)>>;
+
+        template<MembersDesc... Members>
+        using pointer_list = tuple<member_pointer<Members>...>;
+
+        template<MembersDesc... Members>
+        using const_pointer_list = tuple<member_const_pointer<Members>...>;
+
+        template<MembersDesc... Members>
+        using row_ref = row_reference<typename members_layout::template member_type<static_cast<size_t>(Members)>&...>;
+
+        template<MembersDesc... Members>
+        using const_row_ref = row_reference<const typename members_layout::template member_type<static_cast<size_t>(Members)>&...>;
+
+        template<MembersDesc... Members>
+        using rvalue_row_ref = row_reference<typename members_layout::template member_type<static_cast<size_t>(Members)>&&...>;
+
+        template<template<MembersDesc...> typename Template, size_t... I>
+        static Template<static_cast<MembersDesc>(I)...> all_members(index_sequence<I...>);
+
+        template<template<MembersDesc...> typename Template>
+        using for_all_members = decltype(all_members<Template>(make_index_sequence<members_layout::members_count>{}));
+
+    public:
+        using size_type = size_t;
+        using value_list = typename members_layout::members;
+
+        static constexpr size_t members_count{ members_layout::members_count };
+        static_assert(members_count == static_cast<size_t>(MembersDesc::Count), "The MembersDesc enum must match the number of members");
+
+        template<MembersDesc... Members>
+        using partial_ref_list = tuple<tuple_element_t<static_cast<size_t>(Members), value_list>&...>;
+
+        template<MembersDesc... Members>
+        using partial_const_ref_list = tuple<const tuple_element_t<static_cast<size_t>(Members), value_list>&...>;
+
+        using reference_list = for_all_members<partial_ref_list>;
+        using const_reference_list = for_all_members<partial_const_ref_list>;
+
+        template<MembersDesc Member>
+        using member_type = tuple_element_t<static_cast<size_t>(Member), value_list>;
+
+    public:
+
+        class const_iterator
+        {
+        public:
+            using pointer = for_all_members<const_pointer_list>;
+            using iterator_category = random_access_iterator_tag;
+            using difference_type = ptrdiff_t;
+            using reference = for_all_members<const_row_ref>;
+            using value_type = value_list;
+
+            const_iterator() = default;
+
+            reference operator*() const
+            {
+                return convert<reference>(make_index_sequence<members_count>{});
+            }
+
+            reference operator[](difference_type _offset) const
+            {
+                return *(*this + _offset);
+            }
+
+            template<MembersDesc MemberIndex>
+            const auto& value() const
+            {
+                return *get<static_cast<size_t>(MemberIndex)>(m_ptr);
+            }
+
+            const_iterator& operator++()
+            {
+                apply([](auto&... _obj) { (++_obj, ...); }, m_ptr);
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                const_iterator ret = *this;
+                apply([](auto&... _obj) { (_obj++, ...); }, m_ptr);
+                return ret;
+            }
+
+            const_iterator& operator--()
+            {
+                apply([](auto&... _obj) { (--_obj, ...); }, m_ptr);
+                return *this;
+            }
+
+            const_iterator operator--(int)
+            {
+                const_iterator ret = *this;
+                apply([](auto&... _obj) { (_obj--, ...); }, m_ptr);
+                return ret;
+            }
+
+            const_iterator& operator+=(difference_type _offset)
+            {
+                apply([_offset](auto&... _obj) { ((_obj += _offset), ...); }, m_ptr);
+                return *this;
+            }
+
+            const_iterator& operator-=(difference_type _offset)
+            {
+                return *this += -_offset;
+            }
+
+            const_iterator operator+(difference_type _offset) const
+            {
+                const_iterator ret = *this;
+                return ret += _offset;
+            }
+
+            friend const_iterator operator+(difference_type _offset, const const_iterator& _it)
+            {
+                return _it + _offset;
+            }
+
+            const_iterator operator-(difference_type _offset) const
+            {
+                const_iterator ret = *this;
+                return ret -= _offset;
+            }
+
+            difference_type operator-(const const_iterator& _other) const
+            {
+                return get<0>(m_ptr) - get<0>(_other.m_ptr);
+            }
+
+            bool operator==(const const_iterator& _other) const
+            {
+                return m_ptr == _other.m_ptr;
+            }
+
+            bool operator!=(const const_iterator& _other) const
+            {
+                return m_ptr != _other.m_ptr;
+            }
+
+            bool operator<(const const_iterator& _other) const
+            {
+                return get<0>(m_ptr) < get<0>(_other.m_ptr);
+            }
+
+            bool operator>(const const_iterator& _other) const
+            {
+                return _other < *this;
+            }
+
+            bool operator<=(const const_iterator& _other) const
+            {
+                return !(_other < *this);
+            }
+
+            bool operator>=(const const_iterator& _other) const
+            {
+                return !(*this < _other);
+            }
+
+        protected:
+            pointer m_ptr{};
+
+            template<typename... Args>
+            const_iterator(Args... _args)
+                : m_ptr{ make_tuple(_args...) }
+            {
+            }
+
+            template<typename R, size_t... I>
+            R convert(index_sequence<I...>) const
+            {
+                return { (*get<I>(m_ptr))... };
+            }
+
+            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
+        };
+
+        class iterator : public const_iterator
+        {
+        public:
+            using pointer = for_all_members<pointer_list>;
+            using iterator_category = random_access_iterator_tag;
+            using difference_type = ptrdiff_t;
+            using reference = for_all_members<row_ref>;
+            using value_type = value_list;
+
+            iterator() = default;
+
+            reference operator*() const
+            {
+                return convert<reference>(make_index_sequence<members_count>{});
+            }
+
+            reference operator[](difference_type _offset) const
+            {
+                return *(*this + _offset);
+            }
+
+            // Allows algorithms using std::ranges::iter_move to move the members instead of copying them
+            friend for_all_members<rvalue_row_ref> iter_move(const iterator& _it)
+            {
+                return _it.template convert<for_all_members<rvalue_row_ref>>(make_index_sequence<members_count>{});
+            }
+
+            template<MembersDesc MemberIndex>
+            auto& value()
+            {
+                return *detail::const_pointer_cast<tuple_element_t<static_cast<size_t>(MemberIndex), pointer>>(get<static_cast<size_t>(MemberIndex)>(this->m_ptr));
+            }
+
+            iterator& operator++()
+            {
+                const_iterator::operator++();
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator ret = *this;
+                const_iterator::operator++();
+                return ret;
+            }
+
+            iterator& operator--()
+            {
+                const_iterator::operator--();
+                return *this;
+            }
+
+            iterator operator--(int)
+            {
+                iterator ret = *this;
+                const_iterator::operator--();
+                return ret;
+            }
+
+            iterator& operator+=(difference_type _offset)
+            {
+                const_iterator::operator+=(_offset);
+                return *this;
+            }
+
+            iterator& operator-=(difference_type _offset)
+            {
+                const_iterator::operator-=(_offset);
+                return *this;
+            }
+
+            iterator operator+(difference_type _offset) const
+            {
+                iterator ret = *this;
+                return ret += _offset;
+            }
+
+            friend iterator operator+(difference_type _offset, const iterator& _it)
+            {
+                return _it + _offset;
+            }
+
+            using const_iterator::operator-;
+
+            iterator operator-(difference_type _offset) const
+            {
+                iterator ret = *this;
+                return ret -= _offset;
+            }
+
+        private:
+            using const_iterator::const_iterator;
+
+            template<typename R, size_t... I>
+            R convert(index_sequence<I...>) const
+            {
+                return { static_cast<tuple_element_t<I, R>>(*detail::const_pointer_cast<tuple_element_t<I, pointer>>(get<I>(this->m_ptr)))... };
+            }
+
+            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
+        };
+
+        template<MembersDesc... Members>
+        class partial_const_iterator
+        {
+        public:
+            using pointer = const_pointer_list<Members...>;
+            using iterator_category = random_access_iterator_tag;
+            using difference_type = ptrdiff_t;
+            using reference = const_row_ref<Members...>;
+            using value_type = tuple<tuple_element_t<static_cast<size_t>(Members), value_list>...>;
+
+            partial_const_iterator() = default;
+
+            reference operator*() const
+            {
+                return convert<reference>(make_index_sequence<sizeof...(Members)>{});
+            }
+
+            reference operator[](difference_type _offset) const
+            {
+                return *(*this + _offset);
+            }
+
+            template<MembersDesc MemberIndex>
+            const auto& value()
+            {
+                return *get<getIndex<MemberIndex>()>(m_ptr);
+            }
+
+            partial_const_iterator& operator++()
+            {
+                apply([](auto&... _obj) { (++_obj, ...); }, m_ptr);
+                return *this;
+            }
+
+            partial_const_iterator operator++(int)
+            {
+                partial_const_iterator ret = *this;
+                apply([](auto&... _obj) { (_obj++, ...); }, m_ptr);
+                return ret;
+            }
+
+            partial_const_iterator& operator--()
+            {
+                apply([](auto&... _obj) { (--_obj, ...); }, m_ptr);
+                return *this;
+            }
+
+            partial_const_iterator operator--(int)
+            {
+                partial_const_iterator ret = *this;
+                apply([](auto&... _obj) { (_obj--, ...); }, m_ptr);
+                return ret;
+            }
+
+            partial_const_iterator& operator+=(difference_type _offset)
+            {
+                apply([_offset](auto&... _obj) { ((_obj += _offset), ...); }, m_ptr);
+                return *this;
+            }
+
+            partial_const_iterator& operator-=(difference_type _offset)
+            {
+                return *this += -_offset;
+            }
+
+            partial_const_iterator operator+(difference_type _offset) const
+            {
+                partial_const_iterator ret = *this;
+                return ret += _offset;
+            }
+
+            friend partial_const_iterator operator+(difference_type _offset, const partial_const_iterator& _it)
+            {
+                return _it + _offset;
+            }
+
+            partial_const_iterator operator-(difference_type _offset) const
+            {
+                partial_const_iterator ret = *this;
+                return ret -= _offset;
+            }
+
+            difference_type operator-(const partial_const_iterator& _other) const
+            {
+                return get<0>(m_ptr) - get<0>(_other.m_ptr);
+            }
+
+            bool operator==(const partial_const_iterator& _other) const
+            {
+                return m_ptr == _other.m_ptr;
+            }
+
+            bool operator!=(const partial_const_iterator& _other) const
+            {
+                return m_ptr != _other.m_ptr;
+            }
+
+            bool operator<(const partial_const_iterator& _other) const
+            {
+                return get<0>(m_ptr) < get<0>(_other.m_ptr);
+            }
+
+            bool operator>(const partial_const_iterator& _other) const
+            {
+                return _other < *this;
+            }
+
+            bool operator<=(const partial_const_iterator& _other) const
+            {
+                return !(_other < *this);
+            }
+
+            bool operator>=(const partial_const_iterator& _other) const
+            {
+                return !(*this < _other);
+            }
+
+        protected:
+            static constexpr array<size_t, sizeof...(Members)> ms_mapping{ static_cast<size_t>(Members)... };
+
+            pointer m_ptr{};
+
+            template<typename... Args>
+            partial_const_iterator(Args... _args)
+                : m_ptr{ make_tuple(_args...) }
+            {
+            }
+
+            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
+
+            template<MembersDesc MemberIndex, size_t Index = 0>
+            static constexpr size_t getIndex()
+            {
+                if constexpr (ms_mapping[Index] == static_cast<size_t>(MemberIndex))
+                    return Index;
+                else
+                    return getIndex<MemberIndex, Index + 1>();
+            }
+
+            template<typename R, size_t... I>
+            R convert(index_sequence<I...>) const
+            {
+                return { (*get<I>(this->m_ptr))... };
+            }
+        };
+
+        template<MembersDesc... Members>
+        class partial_iterator : public partial_const_iterator<Members...>
+        {
+            using base_iterator = partial_const_iterator<Members...>;
+
+            // Not sure why calling base_iterator::getIndex() doesn't work
+            template<MembersDesc MemberIndex, size_t Index = 0>
+            static constexpr size_t getIndex()
+            {
+                if constexpr (base_iterator::ms_mapping[Index] == static_cast<size_t>(MemberIndex))
+                    return Index;
+                else
+                    return getIndex<MemberIndex, Index + 1>();
+            }
+
+        public:
+            using pointer = pointer_list<Members...>;
+            using iterator_category = random_access_iterator_tag;
+            using difference_type = ptrdiff_t;
+            using reference = row_ref<Members...>;
+            using value_type = tuple<tuple_element_t<static_cast<size_t>(Members), value_list>...>;
+
+            partial_iterator() = default;
+
+            reference operator*() const
+            {
+                return convert<reference>(make_index_sequence<sizeof...(Members)>{});
+            }
+
+            reference operator[](difference_type _offset) const
+            {
+                return *(*this + _offset);
+            }
+
+            // Allows algorithms using std::ranges::iter_move to move the members instead of copying them
+            friend rvalue_row_ref<Members...> iter_move(const partial_iterator& _it)
+            {
+                return _it.template convert<rvalue_row_ref<Members...>>(make_index_sequence<sizeof...(Members)>{});
+            }
+
+            template<MembersDesc MemberIndex>
+            auto& value()
+            {
+                return *detail::const_pointer_cast<tuple_element_t<getIndex<MemberIndex>(), pointer>>(get<getIndex<MemberIndex>()>(this->m_ptr));
+            }
+
+            partial_iterator& operator++()
+            {
+                base_iterator::operator++();
+                return *this;
+            }
+
+            partial_iterator operator++(int)
+            {
+                partial_iterator ret = *this;
+                base_iterator::operator++();
+                return ret;
+            }
+
+            partial_iterator& operator--()
+            {
+                base_iterator::operator--();
+                return *this;
+            }
+
+            partial_iterator operator--(int)
+            {
+                partial_iterator ret = *this;
+                base_iterator::operator--();
+                return ret;
+            }
+
+            partial_iterator& operator+=(difference_type _offset)
+            {
+                base_iterator::operator+=(_offset);
+                return *this;
+            }
+
+            partial_iterator& operator-=(difference_type _offset)
+            {
+                base_iterator::operator-=(_offset);
+                return *this;
+            }
+
+            partial_iterator operator+(difference_type _offset) const
+            {
+                partial_iterator ret = *this;
+                return ret += _offset;
+            }
+
+            friend partial_iterator operator+(difference_type _offset, const partial_iterator& _it)
+            {
+                return _it + _offset;
+            }
+
+            using base_iterator::operator-;
+
+            partial_iterator operator-(difference_type _offset) const
+            {
+                partial_iterator ret = *this;
+                return ret -= _offset;
+            }
+
+        private:
+            template<typename R, size_t... I>
+            R convert(index_sequence<I...>) const
+            {
+                return { static_cast<tuple_element_t<I, R>>(*detail::const_pointer_cast<tuple_element_t<I, pointer>>(get<I>(this->m_ptr)))... };
+            }
+
+            using base_iterator::partial_const_iterator;
+            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
+        };
+
+    private:
+        // Addressing of the columns by the indexed iterators, from the column pointers of the container
+        struct column_addressing
+        {
+            using table = typename members_layout::column_pointers;
+
+            template<size_t I>
+            using element_type = tuple_element_t<I, value_list>;
+
+            template<size_t I>
+            static auto address(const table& _table, ptrdiff_t _index)
+            {
+                return members_layout::template address<I>(_table, _index);
+            }
+        };
+
+    public:
+        // Iterators holding a pointer to the column table of the container and a single index,
+        // instead of one pointer per member: see detail::indexed_iterator.
+        template<MembersDesc... Members>
+        using partial_indexed_iterator = detail::indexed_iterator<column_addressing, false, MembersDesc, Members...>;
+
+        template<MembersDesc... Members>
+        using partial_const_indexed_iterator = detail::indexed_iterator<column_addressing, true, MembersDesc, Members...>;
+
+        using indexed_iterator = for_all_members<partial_indexed_iterator>;
+        using const_indexed_iterator = for_all_members<partial_const_indexed_iterator>;
+
+        // Non owning view on a range of rows, for a subset of the members. Like the pointer iterators,
+        // it is invalidated when the container reallocates. Copying a view doesn't copy the elements,
+        // so views can be handed to other threads or split in smaller slices.
+        template<MembersDesc... Members>
+        class partial_const_view
+        {
+        public:
+            using size_type = size_t;
+            using iterator = partial_const_iterator<Members...>;
+            using const_iterator = partial_const_iterator<Members...>;
+            using const_reference_list = partial_const_ref_list<Members...>;
+            using value_list = tuple<tuple_element_t<static_cast<size_t>(Members), typename vector_base::value_list>...>;
+
+            partial_const_view() = default;
+
+            size_type size() const
+            {
+                return m_size;
+            }
+
+            bool empty() const
+            {
+                return m_size == 0;
+            }
+
+            template<MembersDesc Member>
+            span<const tuple_element_t<static_cast<size_t>(Member), typename vector_base::value_list>> column() const
+            {
+                static_assert(!members_layout::template is_grouped<static_cast<size_t>(Member)>, "A grouped member has no contiguous column");
+                return { get<position<Member>()>(m_ptr), m_size };
+            }
+
+            template<MembersDesc Member>
+            const auto& at(size_type _index) const
+            {
+                check_index(_index);
+                return get<position<Member>()>(m_ptr)[_index];
+            }
+
+            const_reference_list ref_at(size_type _index) const
+            {
+                check_index(_index);
+                return apply([_index](auto... _columns) { return const_reference_list{ _columns[_index]... }; }, m_ptr);
+            }
+
+            value_list value_at(size_type _index) const
+            {
+                return ref_at(_index);
+            }
+
+            const_iterator begin() const
+            {
+                return apply([](auto... _columns) { return const_iterator{ _columns... }; }, m_ptr);
+            }
+
+            const_iterator end() const
+            {
+                return apply([this](auto... _columns) { return const_iterator{ (_columns + m_size)... }; }, m_ptr);
+            }
+
+            const_iterator cbegin() const
+            {
+                return begin();
+            }
+
+            const_iterator cend() const
+            {
+                return end();
+            }
+
+            // Sub range [_first, _last) of this view
+            partial_const_view slice(size_type _first, size_type _last) const
+            {
+                check_range(_first, _last);
+                return apply([_first, _last](auto... _columns) { return partial_const_view{ _last - _first, (_columns + _first)... }; }, m_ptr);
+            }
+
+        protected:
+            using pointer = const_pointer_list<Members...>;
+
+            void check_range(size_type _first, size_type _last) const
+            {
+                if (_first > _last || _last > m_size)
+                    throw out_of_range{ "soa::vector_base::partial_view::slice: invalid range" };
+            }
+
+            pointer m_ptr{};
+            size_type m_size{};
+
+            template<typename... Pointers>
+            partial_const_view(size_type _size, Pointers... _columns)
+                : m_ptr{ _columns... }
+                , m_size{ _size }
+            {
+            }
+
+            template<MembersDesc Member>
+            static constexpr size_t position()
+            {
+                constexpr array<MembersDesc, sizeof...(Members)> members{ Members... };
+                for (size_t i = 0; i < members.size(); ++i)
+                {
+                    if (members[i] == Member)
+                        return i;
+                }
+                return members.size();
+            }
+
+            void check_index(size_type _index) const
+            {
+                if (_index >= m_size)
+                    throw out_of_range{ "soa::vector_base::partial_const_view: index out of range" };
+            }
+
+            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
+        };
+
+        template<MembersDesc... Members>
+        class partial_view : public partial_const_view<Members...>
+        {
+            using base_view = partial_const_view<Members...>;
+
+        public:
+            using size_type = size_t;
+            using iterator = partial_iterator<Members...>;
+            using const_iterator = partial_const_iterator<Members...>;
+            using reference_list = partial_ref_list<Members...>;
+
+            partial_view() = default;
+
+            template<MembersDesc Member>
+            span<tuple_element_t<static_cast<size_t>(Member), typename vector_base::value_list>> column() const
+            {
+                static_assert(!members_layout::template is_grouped<static_cast<size_t>(Member)>, "A grouped member has no contiguous column");
+                return { mutable_column<base_view::template position<Member>()>(), this->m_size };
+            }
+
+            template<MembersDesc Member>
+            auto& at(size_type _index) const
+            {
+                this->check_index(_index);
+                return mutable_column<base_view::template position<Member>()>()[_index];
+            }
+
+            reference_list ref_at(size_type _index) const
+            {
+                this->check_index(_index);
+                return ref_at_internal(_index, make_index_sequence<sizeof...(Members)>{});
+            }
+
+            iterator begin() const
+            {
+                return begin_internal(0, make_index_sequence<sizeof...(Members)>{});
+            }
+
+            iterator end() const
+            {
+                return begin_internal(this->m_size, make_index_sequence<sizeof...(Members)>{});
+            }
+
+            partial_view slice(size_type _first, size_type _last) const
+            {
+                this->check_range(_first, _last);
+                return slice_internal(_first, _last, make_index_sequence<sizeof...(Members)>{});
+            }
+
+        private:
+            using base_view::base_view;
+
+            template<size_t Index>
+            tuple_element_t<Index, pointer_list<Members...>> mutable_column() const
+            {
+                return detail::const_pointer_cast<tuple_element_t<Index, pointer_list<Members...>>>(get<Index>(this->m_ptr));
+            }
+
+            template<size_t... I>
+            reference_list ref_at_internal(size_type _index, index_sequence<I...>) const
+            {
+                return reference_list{ mutable_column<I>()[_index]... };
+            }
+
+            template<size_t... I>
+            iterator begin_internal(size_type _index, index_sequence<I...>) const
+            {
+                return iterator{ (mutable_column<I>() + _index)... };
+            }
+
+            template<size_t... I>
+            partial_view slice_internal(size_type _first, size_type _last, index_sequence<I...>) const
+            {
+                return partial_view{ _last - _first, (mutable_column<I>() + _first)... };
+            }
+
+            friend class soa::vector_base<MembersDesc, Allocator, Types...>;
+        };
+
+        using view = for_all_members<partial_view>;
+        using const_view = for_all_members<partial_const_view>;
+
+        // Appends rows to the container from several threads at the same time, without a mutex while the reserved capacity lasts.
+        // Each row takes the next index with an atomic increment and is written in place, then rows are published in the order of
+        // their indices: the first published() rows are fully written, and can be read by other threads through published_rows()
+        // while rows are appended. Publishing blocks: push_back waits until the rows of the lower indices are published, so a
+        // stalled thread delays the threads appending after it. Once the capacity is full, the next rows go to an overflow table,
+        // under a lock. The container must not be used otherwise until commit(), called when no thread appends anymore,
+        // which sets its size and moves the overflow rows at its end. commit() is mandatory when rows may overflow the capacity. Rows are built as values first, then moved to their place
+        // once their index is taken, so that a failed construction leaves no hole: the members must be nothrow move constructible.
+        class concurrent_appender
+        {
+        public:
+            explicit concurrent_appender(vector_base& _rows)
+                : m_rows{ _rows }
+                , m_capacity{ _rows.m_capacity }
+                , m_reserved{ _rows.m_size }
+                , m_published{ _rows.m_size }
+                , m_overflow{ _rows.m_allocator }
+            {
+                static_assert(std::is_nothrow_move_constructible_v<value_list>, "Concurrent appends need nothrow move constructible members");
+            }
+
+            concurrent_appender(const concurrent_appender&) = delete;
+            concurrent_appender& operator=(const concurrent_appender&) = delete;
+
+            // Commits the appended rows. Growing the container for the overflow rows may throw: the destructor doesn't throw,
+            // and asserts that no overflow row was left, commit() having to be called when rows may overflow the capacity.
+            ~concurrent_appender()
+            {
+                try
+                {
+                    commit();
+                }
+                catch (...)
+                {
+                }
+                assert(m_overflow.empty() && "soa::vector_base::concurrent_appender: overflow rows were not committed");
+            }
+
+            // Appends a row from the values of its members, and returns the index it has in the container once committed
+            template<typename... Args>
+            size_type push_back(Args&&... _args)
+            {
+                value_list values(std::forward<Args>(_args)...);
+                const size_type index{ m_reserved.fetch_add(1, std::memory_order_relaxed) };
+                if (index >= m_capacity)
+                {
+                    std::lock_guard<std::mutex> lock{ m_overflowMutex };
+                    m_overflow.push_back(std::move(values));
+                    return m_capacity + m_overflow.size() - 1;
+                }
+
+                detail::construct_row(m_rows.m_columns, index, column_arguments(std::move(values)), column_sequence{});
+
+                // Waits for the rows before this one to be published
+                for (size_t spins = 0; m_published.load(std::memory_order_acquire) != index; ++spins)
+                {
+                    if (spins >= ms_spinsBeforeYield)
+                        std::this_thread::yield();
+                }
+                m_published.store(index + 1, std::memory_order_release);
+                return index;
+            }
+
+            // Number of rows of the container which can be read, including the rows it had before
+            size_type published() const
+            {
+                return m_published.load(std::memory_order_acquire);
+            }
+
+            // View on the published rows, for the given members or all the members when none is given
+            template<MembersDesc... Members>
+            auto published_rows() const
+            {
+                if constexpr (sizeof...(Members) == 0)
+                    return m_rows.template slice_internal<true>(0, published(), make_index_sequence<members_count>{});
+                else
+                    return m_rows.template slice_internal<true>(0, published(), index_sequence<static_cast<size_t>(Members)...>{});
+            }
+
+            // Number of rows appended since the capacity was full, waiting for commit()
+            size_type overflow_size() const
+            {
+                std::lock_guard<std::mutex> lock{ m_overflowMutex };
+                return m_overflow.size();
+            }
+
+            // Gives the appended rows to the container. Rows can be appended again afterwards, in the new capacity.
+            // If growing the container for the overflow rows throws, the rows appended in the capacity are committed,
+            // and the overflow rows wait for the next commit.
+            void commit()
+            {
+                m_rows.m_size = m_published.load(std::memory_order_relaxed);
+                if (!m_overflow.empty())
+                {
+                    m_rows.reserve(m_rows.m_size + m_overflow.size());
+                    for (size_type row = 0; row < m_overflow.size(); ++row)
+                        apply([this](auto&... _members) { m_rows.push_back(std::move(_members)...); }, m_overflow.ref_at(row));
+                    m_overflow.clear();
+                }
+
+                m_capacity = m_rows.m_capacity;
+                m_reserved.store(m_rows.m_size, std::memory_order_relaxed);
+                m_published.store(m_rows.m_size, std::memory_order_relaxed);
+            }
+
+        private:
+            static constexpr size_t ms_spinsBeforeYield{ 64 };
+
+            vector_base& m_rows;
+            size_type m_capacity{};
+
+            // Written by all the appending threads, each on its own cache line
+            alignas(detail::cache_line_size) std::atomic<size_type> m_reserved{};
+            alignas(detail::cache_line_size) std::atomic<size_type> m_published{};
+
+            mutable std::mutex m_overflowMutex;
+            vector_base m_overflow;
+        };
+
+        vector_base() = default;
+
+        vector_base(const vector_base& _other)
+            : m_allocator{ _other.m_allocator }
+        {
+            copy_from(_other);
+        }
+
+        // Only throws when the rows of an inline block are moved one by one (see detail::has_inline_storage_v)
+        vector_base(vector_base&& _other) noexcept(!detail::has_inline_storage_v<Allocator> || std::is_nothrow_move_constructible_v<value_list>)
+            : m_allocator{ std::move(_other.m_allocator) }
+        {
+            steal(_other);
+        }
+
+        ~vector_base()
+        {
+            detail::destroy_rows(m_columns, 0, m_size, column_sequence{});
+            free_storage(current_storage());
+        }
+
+        vector_base& operator=(const vector_base& _other)
+        {
+            if (this != &_other)
+            {
+                clear();
+                if constexpr (detail::propagate_on_copy_assignment_v<Allocator>)
+                {
+                    // The block must be freed by the allocator which allocated it
+                    if (!detail::allocators_equal(m_allocator, _other.m_allocator))
+                    {
+                        free_storage(current_storage());
+                        adopt({});
+                    }
+                    m_allocator = _other.m_allocator;
+                }
+                if (m_capacity < _other.m_size)
+                {
+                    free_storage(current_storage());
+                    adopt({});
+                }
+                copy_from(_other);
+            }
+            return *this;
+        }
+
+        vector_base& operator=(vector_base&& _other)
+        {
+            if (this == &_other)
+                return *this;
+
+            // The block is transferred when the allocator propagates, or when both allocators are equal
+            // (stateless allocators, or copies of the same arena for instance): this allocator can then free it.
+            // Otherwise, the elements are moved one by one into memory owned by this allocator.
+            clear();
+            if constexpr (detail::propagate_on_move_assignment_v<Allocator>)
+            {
+                free_storage(current_storage());
+                m_allocator = std::move(_other.m_allocator);
+                steal(_other);
+            }
+            else if constexpr (detail::is_always_equal_v<Allocator>)
+            {
+                free_storage(current_storage());
+                steal(_other);
+            }
+            else if (detail::allocators_equal(m_allocator, _other.m_allocator))
+            {
+                free_storage(current_storage());
+                steal(_other);
+            }
+            else
+            {
+                if (m_capacity < _other.m_size)
+                    reallocate(_other.m_size);
+                detail::move_rows(_other.m_columns, _other.m_size, m_columns, column_sequence{});
+                count_moved(_other.m_size);
+                m_size = _other.m_size;
+                _other.clear();
+            }
+            return *this;
+        }
+
+        // Exchanges the rows of both containers. The blocks are exchanged when the allocators propagate on swap or are equal,
+        // otherwise the rows are moved through a temporary container.
+        void swap(vector_base& _other)
+        {
+            if (this == &_other)
+                return;
+
+            if constexpr (detail::propagate_on_swap_v<Allocator>)
+            {
+                using std::swap;
+                swap(m_allocator, _other.m_allocator);
+            }
+            else if constexpr (!detail::is_always_equal_v<Allocator>)
+            {
+                if (!detail::allocators_equal(m_allocator, _other.m_allocator))
+                {
+                    vector_base tmp{ _other.m_allocator };
+                    tmp = std::move(_other);
+                    _other = std::move(*this);
+                    *this = std::move(tmp);
+                    return;
+                }
+            }
+
+            const storage storage{ current_storage() };
+            const size_type size{ m_size };
+            adopt(_other.current_storage());
+            m_size = _other.m_size;
+            _other.adopt(storage);
+            _other.m_size = size;
+        }
+
+        friend void swap(vector_base& _lhs, vector_base& _rhs)
+        {
+            _lhs.swap(_rhs);
+        }
+
+        explicit vector_base(Allocator _allocator)
+            : m_allocator{ std::move(_allocator) }
+        {
+        }
+
+        explicit vector_base(size_type _count, Allocator _allocator = Allocator())
+            : m_allocator{ std::move(_allocator) }
+        {
+            resize(_count);
+        }
+
+        template<typename... Args>
+        vector_base(size_type _count, Args&&... _args)
+        {
+            resize(_count, _args...);
+        }
+
+        vector_base(size_type _count, const const_reference_list& _value, Allocator _allocator = Allocator())
+            : vector_base{ _allocator }
+        {
+            resize(_count, _value);
+        }
+
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        size_type capacity() const
+        {
+            return m_capacity;
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        static constexpr size_type max_size()
+        {
+            return layout::max_rows();
+        }
+
+        Allocator get_allocator() const
+        {
+            return m_allocator;
+        }
+
+        iterator begin()
+        {
+            return begin_internal(make_index_sequence<members_count>{});
+        }
+
+        const_iterator begin() const
+        {
+            return begin_internal(make_index_sequence<members_count>{});
+        }
+
+        const_iterator cbegin() const
+        {
+            return begin_internal(make_index_sequence<members_count>{});
+        }
+
+        iterator end()
+        {
+            return end_internal(make_index_sequence<members_count>{});
+        }
+
+        const_iterator end() const
+        {
+            return end_internal(make_index_sequence<members_count>{});
+        }
+
+        const_iterator cend() const
+        {
+            return end_internal(make_index_sequence<members_count>{});
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> begin()
+        {
+            return { member_address<static_cast<size_t>(Members)>(0)... };
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> end()
+        {
+            return { member_address<static_cast<size_t>(Members)>(m_size)... };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> begin() const
+        {
+            return { member_address<static_cast<size_t>(Members)>(0)... };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> end() const
+        {
+            return { member_address<static_cast<size_t>(Members)>(m_size)... };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> cbegin() const
+        {
+            return { member_address<static_cast<size_t>(Members)>(0)... };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> cend() const
+        {
+            return { member_address<static_cast<size_t>(Members)>(m_size)... };
+        }
+
+        // Contiguous array of a member
+        template<MembersDesc Member>
+        span<member_type<Member>> column()
+        {
+            static_assert(!members_layout::template is_grouped<static_cast<size_t>(Member)>, "A grouped member has no contiguous column");
+            return { member_address<static_cast<size_t>(Member)>(0), m_size };
+        }
+
+        template<MembersDesc Member>
+        span<const member_type<Member>> column() const
+        {
+            static_assert(!members_layout::template is_grouped<static_cast<size_t>(Member)>, "A grouped member has no contiguous column");
+            return { member_address<static_cast<size_t>(Member)>(0), m_size };
+        }
+
+        // View on the rows [_first, _last), for the given members or all the members when none is given
+        template<MembersDesc... Members>
+        auto slice(size_type _first, size_type _last)
+        {
+            return slice_internal<false, Members...>(_first, _last);
+        }
+
+        template<MembersDesc... Members>
+        auto slice(size_type _first, size_type _last) const
+        {
+            return slice_internal<true, Members...>(_first, _last);
+        }
+
+        // View on all the rows
+        template<MembersDesc... Members>
+        auto slice()
+        {
+            return slice_internal<false, Members...>(0, m_size);
+        }
+
+        template<MembersDesc... Members>
+        auto slice() const
+        {
+            return slice_internal<true, Members...>(0, m_size);
+        }
+
+        // Appender adding rows from several threads, in the capacity reserved beforehand: see concurrent_appender
+        concurrent_appender appender()
+        {
+            return concurrent_appender{ *this };
+        }
+
+        // Indexed iterators on the given members, or on all the members when none is given
+        template<MembersDesc... Members>
+        auto indexed_begin()
+        {
+            return indexed_iterator_at<false, Members...>(0);
+        }
+
+        template<MembersDesc... Members>
+        auto indexed_end()
+        {
+            return indexed_iterator_at<false, Members...>(m_size);
+        }
+
+        template<MembersDesc... Members>
+        auto indexed_begin() const
+        {
+            return indexed_iterator_at<true, Members...>(0);
+        }
+
+        template<MembersDesc... Members>
+        auto indexed_end() const
+        {
+            return indexed_iterator_at<true, Members...>(m_size);
+        }
+
+        template<MembersDesc... Members>
+        auto indexed_cbegin() const
+        {
+            return indexed_iterator_at<true, Members...>(0);
+        }
+
+        template<MembersDesc... Members>
+        auto indexed_cend() const
+        {
+            return indexed_iterator_at<true, Members...>(m_size);
+        }
+
+        void reserve(size_type _capacity)
+        {
+            if (_capacity > m_capacity)
+                reallocate(_capacity);
+        }
+
+        void shrink_to_fit()
+        {
+            if (m_capacity > m_size)
+                reallocate(m_size);
+        }
+
+        void clear()
+        {
+            detail::destroy_rows(m_columns, 0, m_size, column_sequence{});
+            m_size = 0;
+        }
+
+        template<typename... Args>
+        void push_back(Args&&... _args)
+        {
+            if constexpr (sizeof...(_args) == 1)
+            {
+                if constexpr (
+                    is_same_v<decay_t<Args>..., reference_list> ||
+                    is_same_v<decay_t<Args>..., const_reference_list> ||
+                    is_same_v<decay_t<Args>..., value_list>)
+                {
+                    push_back_internal(std::forward<Args>(_args)..., make_index_sequence<members_count>{});
+                }
+                else
+                {
+                    push_back_internal(forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+                }
+            }
+            else
+            {
+                push_back_internal(forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+            }
+        }
+
+        void pop_back()
+        {
+            detail::destroy_rows(m_columns, m_size - 1, 1, column_sequence{});
+            --m_size;
+        }
+
+        // Appends copies of the rows of another table, column by column
+        void append(const vector_base& _other)
+        {
+            const vector_base* const tables[]{ &_other };
+            append_tables<false>(tables, 1, sequential_policy{});
+        }
+
+        // Moves the rows of another table at the end, column by column: the other table is left empty
+        void append(vector_base&& _other)
+        {
+            vector_base* const tables[]{ &_other };
+            append_tables<true>(tables, 1, sequential_policy{});
+        }
+
+        void resize(size_type _size)
+        {
+            if (_size <= m_size)
+            {
+                detail::destroy_rows(m_columns, _size, m_size - _size, column_sequence{});
+                m_size = _size;
+                return;
+            }
+
+            if constexpr (can_reallocate)
+            {
+                if (_size > m_capacity)
+                    reallocate(growth_capacity(_size));
+            }
+
+            grow(_size, m_size, _size - m_size, [](const column_pointers& _columns, size_type _first, size_type _count) {
+                detail::value_construct_rows(_columns, _first, _count, column_sequence{});
+            });
+        }
+
+        template<typename... Args>
+        void resize(size_type _size, Args&&... _args)
+        {
+            if constexpr (sizeof...(_args) == 1)
+            {
+                if constexpr (
+                    is_same_v<decay_t<Args>..., reference_list> ||
+                    is_same_v<decay_t<Args>..., const_reference_list> ||
+                    is_same_v<decay_t<Args>..., value_list>)
+                {
+                    resize_internal(_size, std::forward<Args>(_args)..., make_index_sequence<members_count>{});
+                }
+                else
+                {
+                    resize_internal(_size, forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+                }
+            }
+            else
+            {
+                resize_internal(_size, forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+            }
+        }
+
+        template<typename... Args>
+        void insert(size_type _pos, Args&&... _args)
+        {
+            if constexpr (sizeof...(_args) == 1)
+            {
+                if constexpr (
+                    is_same_v<decay_t<Args>..., reference_list> ||
+                    is_same_v<decay_t<Args>..., const_reference_list> ||
+                    is_same_v<decay_t<Args>..., value_list>)
+                {
+                    insert_internal(_pos, std::forward<Args>(_args)..., make_index_sequence<members_count>{});
+                }
+                else
+                {
+                    insert_internal(_pos, forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+                }
+            }
+            else
+            {
+                insert_internal(_pos, forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+            }
+        }
+
+        size_type erase(size_type _pos)
+        {
+            return erase(_pos, _pos + 1);
+        }
+
+        size_type erase(size_type _startPos, size_type _endPos)
+        {
+            return erase_internal(_startPos, _endPos, column_sequence{});
+        }
+
+        // Removes the row at _pos by moving the last row into it: constant time, but the order of the rows isn't preserved
+        size_type erase_unordered(size_type _pos)
+        {
+            erase_unordered_internal(_pos, column_sequence{});
+            return _pos;
+        }
+
+        // Removes the rows for which _predicate, receiving the given members (or all the members) of each row, returns true.
+        // The predicate is evaluated once per row, then each column is compacted in a single sweep, preserving the order of the rows.
+        // Returns the number of removed rows.
+        template<MembersDesc... Members, typename Predicate>
+        size_type erase_if(Predicate _predicate)
+        {
+            if constexpr (sizeof...(Members) == 0)
+                return erase_if_internal(_predicate, make_index_sequence<members_count>{}, column_sequence{});
+            else
+                return erase_if_internal(_predicate, index_sequence<static_cast<size_t>(Members)...>{}, column_sequence{});
+        }
+
+        // Same as erase_if, but each removed row is replaced by the last row (see erase_unordered):
+        // only the removed rows are moved, and the order of the rows isn't preserved.
+        template<MembersDesc... Members, typename Predicate>
+        size_type erase_if_unordered(Predicate _predicate)
+        {
+            if constexpr (sizeof...(Members) == 0)
+                return erase_if_unordered_internal(_predicate, make_index_sequence<members_count>{});
+            else
+                return erase_if_unordered_internal(_predicate, index_sequence<static_cast<size_t>(Members)...>{});
+        }
+
+        template<MembersDesc I>
+        auto& at(size_type _index)
+        {
+            check_index(_index);
+            return *member_address<static_cast<size_t>(I)>(_index);
+        }
+
+        template<MembersDesc I>
+        const auto& at(size_type _index) const
+        {
+            check_index(_index);
+            return *member_address<static_cast<size_t>(I)>(_index);
+        }
+
+        value_list value_at(size_type _index) const
+        {
+            return at_internal<value_list>(_index, make_index_sequence<members_count>{});
+        }
+
+        reference_list ref_at(size_type _index)
+        {
+            return at_internal<reference_list>(_index, make_index_sequence<members_count>{});
+        }
+
+        const_reference_list ref_at(size_type _index) const
+        {
+            return at_internal<const_reference_list>(_index, make_index_sequence<members_count>{});
+        }
+
+        reference_list front()
+        {
+            return ref_at(0);
+        }
+
+        const_reference_list front() const
+        {
+            return ref_at(0);
+        }
+
+        reference_list back()
+        {
+            return ref_at(size() - 1);
+        }
+
+        const_reference_list back() const
+        {
+            return ref_at(size() - 1);
+        }
+
+        // Sorts the rows in the lexicographic order of the given members, or of all the members when none is given.
+        // Only the key columns are read to compute the order, which is then applied once to every column.
+        // A single arithmetic or enum key is sorted with a radix sort. The sort is stable.
+        template<MembersDesc... Members>
+        void sort()
+        {
+            if constexpr (sizeof...(Members) == 0)
+            {
+                sort_by_internal(std::less<>{}, make_index_sequence<members_count>{});
+            }
+            else if constexpr (sizeof...(Members) == 1 && (detail::is_radix_sortable_v<member_type<Members>> && ...))
+            {
+                const buffer<size_t> order{ detail::radix_order(member_address<static_cast<size_t>(Members)>(0)..., m_size) };
+                permute(order.data(), column_sequence{});
+            }
+            else
+            {
+                sort_by_internal(std::less<>{}, index_sequence<static_cast<size_t>(Members)...>{});
+            }
+        }
+
+        // Stable sort of the rows with a comparison on the given members, or all the members when none is given.
+        // The comparison receives two partial_const_ref_list<Members...> (const_reference_list when sorting on all the members).
+        template<MembersDesc... Members, typename Compare>
+        void sort_by(Compare _compare)
+        {
+            if constexpr (sizeof...(Members) == 0)
+                sort_by_internal(_compare, make_index_sequence<members_count>{});
+            else
+                sort_by_internal(_compare, index_sequence<static_cast<size_t>(Members)...>{});
+        }
+
+        // Indices of the rows for which _predicate, receiving the given members (all the members when none is given), returns true.
+        // The predicate is evaluated on blocks of rows into a mask, which is then compacted into indices, both loops being free
+        // of branches: with arithmetic members, they are vectorized when the predicate is simple enough, its conditions
+        // being best combined with & and | rather than && and ||. Conditions on separate members are best given to select_columns.
+        template<MembersDesc... Members, typename Predicate>
+        selection select(Predicate _predicate) const
+        {
+            if constexpr (sizeof...(Members) == 0)
+                return select_internal(_predicate, make_index_sequence<members_count>{});
+            else
+                return select_internal(_predicate, index_sequence<static_cast<size_t>(Members)...>{});
+        }
+
+        // Same as select, setting the bits of the selected rows in a mask
+        template<MembersDesc... Members, typename Predicate>
+        bitmask select_mask(Predicate _predicate) const
+        {
+            if constexpr (sizeof...(Members) == 0)
+                return select_mask_internal(_predicate, make_index_sequence<members_count>{});
+            else
+                return select_mask_internal(_predicate, index_sequence<static_cast<size_t>(Members)...>{});
+        }
+
+        // Same as select, with a predicate per member, in the order of the members, the selected rows being those for which
+        // all the predicates return true. The members are evaluated one column at a time on blocks of rows, each predicate
+        // reading a single column and AND-ing its results into the mask of the block: with arithmetic members, each pass is
+        // a vectorized loop on a contiguous column, while select gathers the members of each row for its predicate.
+        template<MembersDesc... Members, typename... Predicates>
+        selection select_columns(Predicates... _predicates) const
+        {
+            static_assert(sizeof...(Members) != 0 && sizeof...(Members) == sizeof...(Predicates), "select_columns takes a predicate per member");
+            return select_blocks([&](size_type _first, size_type _count, unsigned char* _matches) {
+                match_columns(_first, _count, _matches, index_sequence<static_cast<size_t>(Members)...>{}, _predicates...);
+            });
+        }
+
+        // Same as select_columns, setting the bits of the selected rows in a mask
+        template<MembersDesc... Members, typename... Predicates>
+        bitmask select_mask_columns(Predicates... _predicates) const
+        {
+            static_assert(sizeof...(Members) != 0 && sizeof...(Members) == sizeof...(Predicates), "select_mask_columns takes a predicate per member");
+            return select_mask_blocks([&](size_type _first, size_type _count, unsigned char* _matches) {
+                match_columns(_first, _count, _matches, index_sequence<static_cast<size_t>(Members)...>{}, _predicates...);
+            });
+        }
+
+        // Container holding copies of the selected rows, in the order of the selection, built one column at a time
+        vector_base gather(const selection& _selection) const
+        {
+            check_selection(_selection);
+            vector_base rows{ m_allocator };
+            rows.reserve(_selection.size());
+            detail::gather_rows(m_columns, _selection.data(), _selection.size(), rows.m_columns, column_sequence{});
+            rows.count_copied(_selection.size());
+            rows.m_size = _selection.size();
+            return rows;
+        }
+
+        vector_base gather(const bitmask& _mask) const
+        {
+            check_mask(_mask);
+            return gather(_mask.to_selection());
+        }
+
+        // Calls _function with the given members of the selected rows (all the members when none is given)
+        template<MembersDesc... Members, typename Function>
+        void for_each(const selection& _selection, Function _function)
+        {
+            for_each_internal(*this, _selection, _function, members_or_all<Members...>{});
+        }
+
+        template<MembersDesc... Members, typename Function>
+        void for_each(const selection& _selection, Function _function) const
+        {
+            for_each_internal(*this, _selection, _function, members_or_all<Members...>{});
+        }
+
+        // Calls _function with the given members of the rows whose bit is set, skipping the empty words of the mask
+        template<MembersDesc... Members, typename Function>
+        void for_each(const bitmask& _mask, Function _function)
+        {
+            for_each_internal(*this, _mask, _function, members_or_all<Members...>{});
+        }
+
+        template<MembersDesc... Members, typename Function>
+        void for_each(const bitmask& _mask, Function _function) const
+        {
+            for_each_internal(*this, _mask, _function, members_or_all<Members...>{});
+        }
+
+        // Reorders the rows in place, so that row i receives the former row _order[i]. _order is a container of indices
+        // (size() and operator[]) holding a permutation of [0, size()), otherwise invalid_argument is thrown before any row moves.
+        // Each column follows the cycles of the permutation with a single temporary, one bit per row marking the rows in place.
+        // With soa::par, several columns are reordered at the same time by different threads.
+        template<typename Order, typename Policy = sequential_policy>
+        void apply_permutation(const Order& _order, const Policy& _policy = {})
+        {
+            if (_order.size() != m_size)
+                throw std::invalid_argument{ "soa::vector_base: the permutation doesn't match the size" };
+
+            buffer<uint64_t> visited((m_size + 63) / 64);
+            for (size_type i = 0; i < m_size; ++i)
+            {
+                const size_t row{ static_cast<size_t>(_order[i]) };
+                if (row >= m_size || (visited[row / 64] >> (row % 64)) & 1)
+                    throw std::invalid_argument{ "soa::vector_base: invalid permutation" };
+                visited[row / 64] |= uint64_t{ 1 } << (row % 64);
+            }
+
+            if constexpr (detail::is_contiguous_order_v<Order>)
+            {
+                permute(_order.data(), _policy, column_sequence{});
+            }
+            else
+            {
+                buffer<size_t> order(m_size);
+                for (size_type i = 0; i < m_size; ++i)
+                    order[i] = static_cast<size_t>(_order[i]);
+                permute(order.data(), _policy, column_sequence{});
+            }
+        }
+
+        // Reorders the rows in place on the keys returned by _key, receiving the given members of each row (all the members
+        // when none is given), as a stable sort. The key of each row is computed once, and arithmetic keys are sorted with a radix sort:
+        // for instance, rows are ordered along a space filling curve by returning the Morton code of their position.
+        template<MembersDesc... Members, typename KeyFunction, typename Policy = sequential_policy>
+        void reorder_by(KeyFunction _key, const Policy& _policy = {})
+        {
+            reorder_by_internal(_key, _policy, members_or_all<Members...>{});
+        }
+
+#ifdef SOA_STATS
+        using stats_type = container_stats<members_layout::columns_count>;
+
+        // Counters since the construction of the container or the last reset_stats()
+        const stats_type& stats() const
+        {
+            return m_stats;
+        }
+
+        void reset_stats()
+        {
+            m_stats = {};
+        }
+#endif
+
+    protected:
+        // The allocator itself, which get_allocator copies
+        const Allocator& allocator() const
+        {
+            return m_allocator;
+        }
+
+        // Sets the capacity to exactly _capacity rows, which must not be less than the size.
+        // For the containers built on vector_base managing their own capacity, see small_vector_base.
+        void reallocate_exact(size_type _capacity)
+        {
+            if (_capacity != m_capacity)
+                reallocate(_capacity);
+        }
+
+        // Appends the rows of several tables in their order, copied, or moved when Move is true, the tables being then left empty.
+        // Each column of each table is a task: with a parallel_policy, the columns are copied by several threads.
+        // On exception, no row is appended, the rows of the moved tables being possibly moved from.
+        template<bool Move, typename Table, typename Policy>
+        void append_tables(Table* const* _tables, size_t _count, const Policy& _policy)
+        {
+            buffer<size_type> offsets(_count + 1);
+            offsets[0] = m_size;
+            for (size_t table = 0; table < _count; ++table)
+                offsets[table + 1] = offsets[table] + _tables[table]->m_size;
+            if (offsets[_count] > max_size())
+                throw length_error{ "soa::vector_base: too many rows" };
+            if (offsets[_count] > m_capacity)
+                reallocate(growth_capacity(offsets[_count]));
+
+            constexpr size_t columns{ members_layout::columns_count };
+            const size_t tasks{ _count * columns };
+            buffer<unsigned char> done(tasks);
+            const auto append_column = [&](size_t _task) {
+                const size_t table{ _task / columns };
+                append_column_of<Move>(*_tables[table], _task % columns, offsets[table], column_sequence{});
+                done[_task] = 1;
+            };
+
+            try
+            {
+                if constexpr (std::is_same_v<Policy, parallel_policy>)
+                {
+                    if (offsets[_count] - m_size >= _policy.min_rows)
+                        detail::run_parallel(tasks, detail::policy_threads(_policy), append_column);
+                    else
+                        for (size_t task = 0; task < tasks; ++task)
+                            append_column(task);
+                }
+                else
+                {
+                    for (size_t task = 0; task < tasks; ++task)
+                        append_column(task);
+                }
+            }
+            catch (...)
+            {
+                for (size_t task = 0; task < tasks; ++task)
+                {
+                    const size_t table{ task / columns };
+                    if (done[task])
+                        destroy_column(task % columns, offsets[table], offsets[table + 1] - offsets[table], column_sequence{});
+                }
+                throw;
+            }
+
+            if constexpr (Move)
+            {
+                count_moved(offsets[_count] - m_size);
+                for (size_t table = 0; table < _count; ++table)
+                    _tables[table]->clear();
+            }
+            else
+            {
+                count_copied(offsets[_count] - m_size);
+            }
+            m_size = offsets[_count];
+        }
+
+    private:
+        // All the columns live in a single block allocated from the allocator,
+        // and share the same size and capacity (see detail::block_layout).
+        using layout = typename members_layout::block;
+        using block_unit = typename layout::unit;
+
+        // The block can be grown by the allocator, see reallocate_in_place
+        static constexpr bool can_reallocate{ members_layout::trivially_copyable && detail::has_reallocate_v<Allocator, block_unit> };
+        using column_pointers = typename members_layout::column_pointers;
+        using column_sequence = make_index_sequence<members_layout::columns_count>;
+
+        struct storage
+        {
+            block_unit* block{};
+            column_pointers columns{};
+            size_type capacity{};
+        };
+
+        // Address of a member in a row
+        template<size_t I>
+        typename members_layout::template pointer<I> member_address(size_type _index) const
+        {
+            return members_layout::template address<I>(m_columns, static_cast<ptrdiff_t>(_index));
+        }
+
+        template<size_t... I>
+        iterator begin_internal(index_sequence<I...>)
+        {
+            return { member_address<I>(0)... };
+        }
+
+        template<size_t... I>
+        const_iterator begin_internal(index_sequence<I...>) const
+        {
+            return { member_address<I>(0)... };
+        }
+
+        template<size_t... I>
+        iterator end_internal(index_sequence<I...>)
+        {
+            return { member_address<I>(m_size)... };
+        }
+
+        template<size_t... I>
+        const_iterator end_internal(index_sequence<I...>) const
+        {
+            return { member_address<I>(m_size)... };
+        }
+
+        template<bool IsConst, MembersDesc... Members>
+        auto slice_internal(size_type _first, size_type _last) const
+        {
+            if (_first > _last || _last > m_size)
+                throw out_of_range{ "soa::vector_base::slice: invalid range" };
+
+            if constexpr (sizeof...(Members) == 0)
+                return slice_internal<IsConst>(_first, _last, make_index_sequence<members_count>{});
+            else
+                return slice_internal<IsConst>(_first, _last, index_sequence<static_cast<size_t>(Members)...>{});
+        }
+
+        template<bool IsConst, size_t... I>
+        auto slice_internal(size_type _first, size_type _last, index_sequence<I...>) const
+        {
+            using view_type = std::conditional_t<IsConst, partial_const_view<static_cast<MembersDesc>(I)...>, partial_view<static_cast<MembersDesc>(I)...>>;
+            return view_type{ _last - _first, member_address<I>(_first)... };
+        }
+
+        template<bool IsConst, MembersDesc... Members>
+        auto indexed_iterator_at(size_type _index) const
+        {
+            using table = typename column_addressing::table;
+            if constexpr (sizeof...(Members) == 0)
+                return std::conditional_t<IsConst, const_indexed_iterator, indexed_iterator>{ &m_columns, static_cast<ptrdiff_t>(_index) };
+            else
+                return detail::indexed_iterator<column_addressing, IsConst, MembersDesc, Members...>{ static_cast<const table*>(&m_columns), static_cast<ptrdiff_t>(_index) };
+        }
+
+        // Constructor arguments of the columns, from the arguments of the members:
+        // a group column receives a tuple of the arguments of its members
+        template<typename Tuple>
+        static decltype(auto) column_arguments(Tuple&& _args)
+        {
+            if constexpr (members_layout::has_groups)
+                return column_arguments(std::forward<Tuple>(_args), column_sequence{});
+            else
+                return std::forward<Tuple>(_args);
+        }
+
+        template<typename Tuple, size_t... C>
+        static auto column_arguments(Tuple&& _args, index_sequence<C...>)
+        {
+            return tuple<decltype(column_argument<C>(std::forward<Tuple>(_args)))...>{ column_argument<C>(std::forward<Tuple>(_args))... };
+        }
+
+        template<size_t Column, typename Tuple>
+        static decltype(auto) column_argument(Tuple&& _args)
+        {
+            if constexpr (members_layout::column_size[Column] > 1)
+                return group_arguments<members_layout::first_member[Column]>(std::forward<Tuple>(_args), make_index_sequence<members_layout::column_size[Column]>{});
+            else
+                return get<members_layout::first_member[Column]>(std::forward<Tuple>(_args));
+        }
+
+        template<size_t First, typename Tuple, size_t... I>
+        static auto group_arguments(Tuple&& _args, index_sequence<I...>)
+        {
+            return forward_as_tuple(get<First + I>(std::forward<Tuple>(_args))...);
+        }
+
+        // Values of the columns, from the values of the members
+        template<typename Tuple>
+        static decltype(auto) column_values(const Tuple& _values)
+        {
+            if constexpr (members_layout::has_groups)
+                return column_values(_values, column_sequence{});
+            else
+                return _values;
+        }
+
+        template<typename Tuple, size_t... C>
+        static typename members_layout::columns column_values(const Tuple& _values, index_sequence<C...>)
+        {
+            return typename members_layout::columns(column_argument<C>(_values)...);
+        }
+
+        template<typename Tuple, size_t... I>
+        void push_back_internal(Tuple&& _args, index_sequence<I...> _sequence)
+        {
+            if constexpr (can_reallocate)
+            {
+                // The block is reallocated before the new row is constructed, so the arguments,
+                // which may reference rows of this container, are copied first
+                if (m_size == m_capacity)
+                {
+                    value_list values(get<I>(std::forward<Tuple>(_args))...);
+                    reallocate(growth_capacity(m_size + 1));
+                    push_back_internal(std::move(values), _sequence);
+                    return;
+                }
+            }
+
+            grow(m_size + 1, m_size, 1, [&_args](const column_pointers& _columns, size_type _first, size_type /*_count*/) {
+                detail::construct_row(_columns, _first, column_arguments(std::forward<Tuple>(_args)), column_sequence{});
+            });
+        }
+
+        template<typename Tuple, size_t... I>
+        void resize_internal(size_type _size, Tuple&& _args, index_sequence<I...> _sequence)
+        {
+            if (_size <= m_size)
+            {
+                resize(_size);
+                return;
+            }
+
+            if constexpr (can_reallocate)
+            {
+                if (_size > m_capacity)
+                {
+                    const value_list values(get<I>(_args)...);
+                    reallocate(growth_capacity(_size));
+                    resize_internal(_size, values, _sequence);
+                    return;
+                }
+            }
+
+            grow(_size, m_size, _size - m_size, [&_args](const column_pointers& _columns, size_type _first, size_type _count) {
+                detail::fill_construct_rows(_columns, _first, _count, column_values(_args), column_sequence{});
+            });
+        }
+
+        template<typename Tuple, size_t... I>
+        void insert_internal(size_type _pos, Tuple&& _args, index_sequence<I...> _sequence)
+        {
+            if constexpr (can_reallocate)
+            {
+                if (m_size == m_capacity)
+                {
+                    value_list values(get<I>(std::forward<Tuple>(_args))...);
+                    reallocate(growth_capacity(m_size + 1));
+                    insert_internal(_pos, std::move(values), _sequence);
+                    return;
+                }
+            }
+
+            if (_pos == m_size || m_size == m_capacity)
+            {
+                // The new row is constructed in place, in the new block if any, before any existing row is moved
+                grow(m_size + 1, _pos, 1, [&_args](const column_pointers& _columns, size_type _first, size_type /*_count*/) {
+                    detail::construct_row(_columns, _first, column_arguments(std::forward<Tuple>(_args)), column_sequence{});
+                });
+                return;
+            }
+
+            // The arguments may reference elements that are about to be shifted, so they are copied first
+            value_list values(get<I>(std::forward<Tuple>(_args))...);
+            shift_up_rows(_pos, column_sequence{});
+            count_moved(m_size - _pos);
+            ((*member_address<I>(_pos) = std::move(get<I>(values))), ...);
+            ++m_size;
+        }
+
+        template<size_t... I>
+        void shift_up_rows(size_type _pos, index_sequence<I...>)
+        {
+            (shift_up(get<I>(m_columns), _pos, m_size), ...);
+        }
+
+        template<size_t... I>
+        size_type erase_internal(size_type _startPos, size_type _endPos, index_sequence<I...> _sequence)
+        {
+            if (_startPos == _endPos)
+                return _startPos;
+
+            (shift_down(get<I>(m_columns), _startPos, _endPos, m_size), ...);
+            count_moved(m_size - _endPos);
+            const size_type count{ _endPos - _startPos };
+            detail::destroy_rows(m_columns, m_size - count, count, _sequence);
+            m_size -= count;
+            return _startPos;
+        }
+
+        template<size_t... I>
+        void erase_unordered_internal(size_type _pos, index_sequence<I...> _sequence)
+        {
+            const size_type last{ m_size - 1 };
+            if (_pos != last)
+            {
+                ((get<I>(m_columns)[_pos] = std::move(get<I>(m_columns)[last])), ...);
+                count_moved(1);
+            }
+            detail::destroy_rows(m_columns, last, 1, _sequence);
+            m_size = last;
+        }
+
+        template<typename Predicate, size_t... K, size_t... I>
+        size_type erase_if_internal(Predicate& _predicate, index_sequence<K...>, index_sequence<I...> _sequence)
+        {
+            // Rows are only read until the first removed one
+            size_type first{};
+            while (first < m_size && !_predicate(std::as_const(*member_address<K>(first))...))
+                ++first;
+            if (first == m_size)
+                return 0;
+
+            buffer<unsigned char> removed(m_size - first);
+            removed[0] = 1;
+            for (size_type i = first + 1; i < m_size; ++i)
+                removed[i - first] = _predicate(std::as_const(*member_address<K>(i))...) ? 1 : 0;
+
+            size_type kept{};
+            ((kept = compact_column(get<I>(m_columns), first, m_size, removed.data())), ...);
+            count_moved(kept - first);
+            const size_type count{ m_size - kept };
+            detail::destroy_rows(m_columns, kept, count, _sequence);
+            m_size = kept;
+            return count;
+        }
+
+        // Rows evaluated at once by select, the mask of a block staying in the L1 cache
+        static constexpr size_type ms_selectBlock{ 256 };
+
+        template<MembersDesc... Members>
+        using members_or_all = std::conditional_t<sizeof...(Members) == 0, make_index_sequence<members_count>, index_sequence<static_cast<size_t>(Members)...>>;
+
+        template<typename Predicate, size_t... K>
+        selection select_internal(Predicate& _predicate, index_sequence<K...>) const
+        {
+            return select_blocks([&](size_type _first, size_type _count, unsigned char* _matches) {
+                for (size_type i = 0; i < _count; ++i)
+                    _matches[i] = _predicate(std::as_const(*member_address<K>(_first + i))...) ? 1 : 0;
+            });
+        }
+
+        template<typename Predicate, size_t... K>
+        bitmask select_mask_internal(Predicate& _predicate, index_sequence<K...>) const
+        {
+            return select_mask_blocks([&](size_type _first, size_type _count, unsigned char* _matches) {
+                for (size_type i = 0; i < _count; ++i)
+                    _matches[i] = _predicate(std::as_const(*member_address<K>(_first + i))...) ? 1 : 0;
+            });
+        }
+
+        // Evaluates the predicates on the rows [_first, _first + _count), one member at a time
+        template<size_t... K, typename... Predicates>
+        void match_columns(size_type _first, size_type _count, unsigned char* _matches, index_sequence<K...>, Predicates&... _predicates) const
+        {
+            std::fill_n(_matches, _count, static_cast<unsigned char>(1));
+            (match_column<K>(_first, _count, _matches, _predicates), ...);
+        }
+
+        template<size_t K, typename Predicate>
+        void match_column(size_type _first, size_type _count, unsigned char* _matches, Predicate& _predicate) const
+        {
+            for (size_type i = 0; i < _count; ++i)
+                _matches[i] &= _predicate(std::as_const(*member_address<K>(_first + i))) ? 1 : 0;
+        }
+
+        // _match(first, count, matches) sets matches[i] to 1 for the selected rows of a block, 0 for the others
+        template<typename Match>
+        selection select_blocks(Match _match) const
+        {
+            buffer<size_t> indices;
+            size_type selected{};
+            unsigned char matches[ms_selectBlock];
+            for (size_type first = 0; first < m_size; first += ms_selectBlock)
+            {
+                const size_type count{ m_size - first < ms_selectBlock ? m_size - first : ms_selectBlock };
+                _match(first, count, matches);
+
+                indices.resize(selected + count);
+                size_t* out{ indices.data() + selected };
+                size_type matched{};
+                for (size_type i = 0; i < count; ++i)
+                {
+                    out[matched] = first + i;
+                    matched += matches[i];
+                }
+                selected += matched;
+            }
+            indices.resize(selected);
+            return selection{ std::move(indices) };
+        }
+
+        template<typename Match>
+        bitmask select_mask_blocks(Match _match) const
+        {
+            static_assert(ms_selectBlock % 64 == 0, "The blocks must fill whole words of the mask");
+
+            bitmask mask{ m_size };
+            uint64_t* words{ mask.words() };
+            unsigned char matches[ms_selectBlock];
+            for (size_type first = 0; first < m_size; first += ms_selectBlock)
+            {
+                const size_type count{ m_size - first < ms_selectBlock ? m_size - first : ms_selectBlock };
+                _match(first, count, matches);
+
+                for (size_type word = 0; word * 64 < count; ++word)
+                {
+                    const size_type bits{ count - word * 64 < 64 ? count - word * 64 : 64 };
+                    uint64_t value{};
+                    for (size_type i = 0; i < bits; ++i)
+                        value |= static_cast<uint64_t>(matches[word * 64 + i]) << i;
+                    words[first / 64 + word] = value;
+                }
+            }
+            return mask;
+        }
+
+        // The indices of a selection are increasing: checking the last one is enough
+        void check_selection(const selection& _selection) const
+        {
+            if (!_selection.empty() && _selection[_selection.size() - 1] >= m_size)
+                throw out_of_range{ "soa::vector_base: the selection has rows out of range" };
+        }
+
+        void check_mask(const bitmask& _mask) const
+        {
+            if (_mask.size() != m_size)
+                throw std::invalid_argument{ "soa::vector_base: the mask doesn't match the size" };
+        }
+
+        template<typename Self, typename Function, size_t... K>
+        static void for_each_internal(Self& _self, const selection& _selection, Function& _function, index_sequence<K...>)
+        {
+            _self.check_selection(_selection);
+            for (size_t row : _selection)
+                call_on_row<Self>(_self, row, _function, index_sequence<K...>{});
+        }
+
+        template<typename Self, typename Function, size_t... K>
+        static void for_each_internal(Self& _self, const bitmask& _mask, Function& _function, index_sequence<K...>)
+        {
+            _self.check_mask(_mask);
+            for (size_type i = 0; i < _mask.word_count(); ++i)
+            {
+                for (uint64_t word = _mask.words()[i]; word != 0; word &= word - 1)
+                    call_on_row<Self>(_self, i * 64 + detail::countr_zero(word), _function, index_sequence<K...>{});
+            }
         }
 
-        template<MembersDesc... Members>
-        partial_const_iterator<Members...> begin() const
+        // The members are given as const references when the container is const
+        template<typename Self, typename Function, size_t... K>
+        static void call_on_row(const vector_base& _self, size_type _row, Function& _function, index_sequence<K...>)
         {
-            return { get<static_cast<size_t>(Members)>(m_soa).data()... };
+            if constexpr (std::is_const_v<Self>)
+                _function(std::as_const(*_self.member_address<K>(_row))...);
+            else
+                _function(*_self.member_address<K>(_row)...);
         }
 
-        template<MembersDesc... Members>
-        partial_const_iterator<Members...> end() const
+        // Moves the rows of [_first, _end) not flagged in _removed down, returns the new end of the column
+        template<typename T>
+        static size_type compact_column(T* _column, size_type _first, size_type _end, const unsigned char* _removed)
         {
-            const size_type size{ this->size() };
-            return { get<static_cast<size_t>(Members)>(m_soa).data() + size... };
+            size_type last{ _first };
+            for (size_type i = _first; i < _end; ++i)
+            {
+                if (!_removed[i - _first])
+                {
+                    _column[last] = std::move(_column[i]);
+                    ++last;
+                }
+            }
+            return last;
         }
 
-        template<MembersDesc... Members>
-        partial_const_iterator<Members...> cbegin() const
+        template<typename Predicate, size_t... K>
+        size_type erase_if_unordered_internal(Predicate& _predicate, index_sequence<K...>)
         {
-            return { get<static_cast<size_t>(Members)>(m_soa).data()... };
+            const size_type size{ m_size };
+            size_type i{};
+            while (i < m_size)
+            {
+                // The row moved into a removed row hasn't been tested yet
+                if (_predicate(std::as_const(*member_address<K>(i))...))
+                    erase_unordered_internal(i, column_sequence{});
+                else
+                    ++i;
+            }
+            return size - m_size;
         }
 
-        template<MembersDesc... Members>
-        partial_const_iterator<Members...> cend() const
+        template<typename ReturnType, size_t... I>
+        ReturnType at_internal(size_type _index, index_sequence<I...>)
         {
-            const size_type size{ this->size() };
-            return { get<static_cast<size_t>(Members)>(m_soa).data() + size... };
+            check_index(_index);
+            return forward_as_tuple(*member_address<I>(_index)...);
         }
 
-        void reserve(size_type _capacity)
+        template<typename ReturnType, size_t... I>
+        ReturnType at_internal(size_type _index, index_sequence<I...>) const
         {
-            apply([_capacity](auto&&... _vec) { (_vec.reserve(_capacity), ...); }, m_soa);
+            check_index(_index);
+            return forward_as_tuple(std::as_const(*member_address<I>(_index))...);
         }
 
-        void shrink_to_fit()
+        template<typename Compare, size_t... I>
+        void sort_by_internal(Compare _compare, index_sequence<I...>)
         {
-            apply([](auto&&... _vec) { (_vec.shrink_to_fit(), ...); }, m_soa);
+            buffer<size_t> order(m_size);
+            for (size_t i = 0; i < m_size; ++i)
+                order[i] = i;
+
+            std::stable_sort(order.begin(), order.end(), [this, &_compare](size_t _lhs, size_t _rhs) {
+                return _compare(
+                    tuple<const tuple_element_t<I, value_list>&...>{ *member_address<I>(_lhs)... },
+                    tuple<const tuple_element_t<I, value_list>&...>{ *member_address<I>(_rhs)... });
+            });
+            permute(order.data(), column_sequence{});
         }
 
-        void clear()
+        // Applies the same permutation to every column, in place: row i receives the former row _order[i]
+        template<size_t... I>
+        void permute(const size_t* _order, index_sequence<I...>)
         {
-            apply([](auto&&... _vec) {	(_vec.clear(), ...); }, m_soa);
+            buffer<uint64_t> visited((m_size + 63) / 64);
+            (detail::permute_column(get<I>(m_columns), m_size, _order, visited.data()), ...);
         }
 
-        template<typename... Args>
-        void push_back(Args&&... _args)
+        template<bool Move, typename Table, size_t... C>
+        void append_column_of(Table& _table, size_t _column, size_type _offset, index_sequence<C...>)
         {
-            if constexpr (sizeof...(_args) == 1)
-            {
-                if constexpr (
-                    is_same_v<decay_t<Args>..., reference_list> ||
-                    is_same_v<decay_t<Args>..., const_reference_list> ||
-                    is_same_v<decay_t<Args>..., value_list>)
-                {
-                    push_back_internal(std::forward<Args>(_args)..., make_index_sequence<members_count>{});
-                }
-                else
-                {
-                    push_back_internal(forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
-                }
-            }
+            if constexpr (Move)
+                ((_column == C ? detail::move_column(get<C>(_table.m_columns), _table.m_size, get<C>(m_columns) + _offset) : void()), ...);
             else
-            {
-                push_back_internal(forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
-            }
+                ((_column == C ? detail::copy_column(get<C>(_table.m_columns), _table.m_size, get<C>(m_columns) + _offset) : void()), ...);
         }
 
-        void pop_back()
+        template<size_t... C>
+        void destroy_column(size_t _column, size_type _first, size_type _count, index_sequence<C...>)
         {
-            apply([](auto&&... _vec) {	(_vec.pop_back(), ...); }, m_soa);
+            ((_column == C ? (void)std::destroy_n(get<C>(m_columns) + _first, _count) : void()), ...);
         }
 
-        void resize(size_type _size)
+        template<size_t... I>
+        void permute(const size_t* _order, const sequential_policy&, index_sequence<I...> _sequence)
         {
-            apply([_size](auto&&... _vec) { (_vec.resize(_size), ...); }, m_soa);
+            permute(_order, _sequence);
         }
 
-        template<typename... Args>
-        void resize(size_type _size, Args&&... _args)
+        // Each task permutes a column, with its own visited bits
+        template<size_t... I>
+        void permute(const size_t* _order, const parallel_policy& _policy, index_sequence<I...> _sequence)
         {
-            if constexpr (sizeof...(_args) == 1)
-            {
-                if constexpr (
-                    is_same_v<decay_t<Args>..., reference_list> ||
-                    is_same_v<decay_t<Args>..., const_reference_list> ||
-                    is_same_v<decay_t<Args>..., value_list>)
-                {
-                    resize_internal(_size, std::forward<Args>(_args)..., make_index_sequence<members_count>{});
-                }
-                else
-                {
-                    resize_internal(_size, forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
-                }
-            }
-            else
+            if (m_size < _policy.min_rows)
             {
-                resize_internal(_size, forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+                permute(_order, _sequence);
+                return;
             }
+
+            detail::run_parallel(sizeof...(I), detail::policy_threads(_policy), [this, _order](size_t _column) {
+                buffer<uint64_t> visited((m_size + 63) / 64);
+                ((_column == I ? detail::permute_column(get<I>(m_columns), m_size, _order, visited.data()) : void()), ...);
+            });
         }
 
-        template<typename... Args>
-        void insert(size_type _pos, Args&&... _args)
+        template<typename KeyFunction, typename Policy, size_t... K>
+        void reorder_by_internal(KeyFunction& _key, const Policy& _policy, index_sequence<K...>)
         {
-            if constexpr (sizeof...(_args) == 1)
+            using key_type = decay_t<decltype(_key(std::as_const(*member_address<K>(0))...))>;
+            buffer<key_type> keys;
+            keys.reserve(m_size);
+            for (size_type i = 0; i < m_size; ++i)
+                keys.push_back(_key(std::as_const(*member_address<K>(i))...));
+
+            if constexpr (detail::is_radix_sortable_v<key_type>)
             {
-                if constexpr (
-                    is_same_v<decay_t<Args>..., reference_list> ||
-                    is_same_v<decay_t<Args>..., const_reference_list> ||
-                    is_same_v<decay_t<Args>..., value_list>)
-                {
-                    insert_internal(_pos, std::forward<Args>(_args)..., make_index_sequence<members_count>{});
-                }
-                else
-                {
-                    insert_internal(_pos, forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
-                }
+                const buffer<size_t> order{ detail::radix_order(keys.data(), m_size) };
+                permute(order.data(), _policy, column_sequence{});
             }
             else
             {
-                insert_internal(_pos, forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+                buffer<size_t> order(m_size);
+                for (size_t i = 0; i < m_size; ++i)
+                    order[i] = i;
+                std::stable_sort(order.begin(), order.end(), [&keys](size_t _lhs, size_t _rhs) { return keys[_lhs] < keys[_rhs]; });
+                permute(order.data(), _policy, column_sequence{});
             }
         }
 
-        size_type erase(size_type _pos)
+        void check_index(size_type _index) const
         {
-            return erase(_pos, _pos + 1);
+            if (_index >= m_size)
+                throw out_of_range{ "soa::vector_base: index out of range" };
         }
 
-        size_type erase(size_type _startPos, size_type _endPos)
+        // Moves the element before _end one slot further, making room at _pos
+        template<typename T>
+        static void shift_up(T* _column, size_type _pos, size_type _end)
         {
-            return erase_internal(_startPos, _endPos, make_index_sequence<members_count>{});
+            if constexpr (std::is_trivially_copyable_v<T>)
+            {
+                detail::move_bytes(_column + _pos, _end - _pos, _column + _pos + 1);
+            }
+            else
+            {
+                ::new (static_cast<void*>(_column + _end)) T(std::move(_column[_end - 1]));
+                std::move_backward(_column + _pos, _column + _end - 1, _column + _end);
+            }
         }
 
-        template<MembersDesc I>
-        auto& at(size_type _index)
+        // Moves the elements [_endPos, _end) to _startPos, leaving moved-from elements at the end
+        template<typename T>
+        static void shift_down(T* _column, size_type _startPos, size_type _endPos, size_type _end)
         {
-            return get<static_cast<size_t>(I)>(m_soa).at(_index);
+            if constexpr (std::is_trivially_copyable_v<T>)
+                detail::move_bytes(_column + _endPos, _end - _endPos, _column + _startPos);
+            else
+                std::move(_column + _endPos, _column + _end, _column + _startPos);
         }
 
-        template<MembersDesc I>
-        const auto& at(size_type _index) const
+        storage current_storage() const
         {
-            return get<static_cast<size_t>(I)>(m_soa).at(_index);
+            return { m_block, m_columns, m_capacity };
         }
 
-        value_list value_at(size_type _index) const
+        storage allocate_storage(size_type _capacity)
         {
-            return at_internal<value_list>(_index, make_index_sequence<members_count>{});
+            if (_capacity == 0)
+                return {};
+
+            if (_capacity > max_size())
+                throw length_error{ "soa::vector_base: capacity exceeds max_size()" };
+
+            block_unit* block{ m_allocator.template allocate<block_unit>(layout::units(_capacity)) };
+            if (block == nullptr)
+                throw bad_alloc{};
+
+            count_allocation(_capacity);
+            return { block, layout::columns(block, _capacity), _capacity };
         }
 
-        reference_list ref_at(size_type _index)
+        void free_storage(const storage& _storage)
         {
-            return at_internal<reference_list>(_index, make_index_sequence<members_count>{});
+            if (_storage.block != nullptr)
+            {
+                detail::free_block(m_allocator, _storage.block, layout::units(_storage.capacity));
+                count_free();
+            }
         }
 
-        const_reference_list ref_at(size_type _index) const
+        void adopt(const storage& _storage)
         {
-            return at_internal<const_reference_list>(_index, make_index_sequence<members_count>{});
+            m_block = _storage.block;
+            m_columns = _storage.columns;
+            m_capacity = _storage.capacity;
         }
 
-        reference_list front()
+        // The current storage must have been released
+        void steal(vector_base& _other)
         {
-            return ref_at(0);
+            if constexpr (detail::has_inline_storage_v<Allocator>)
+            {
+                // The block lives inside the allocator of the other container, which keeps it: the rows are moved to a block of this one
+                if (_other.m_block != nullptr && _other.m_allocator.is_inline(_other.m_block))
+                {
+                    adopt({});
+                    adopt(allocate_storage(_other.m_capacity));
+                    detail::move_rows(_other.m_columns, _other.m_size, m_columns, column_sequence{});
+                    count_moved(_other.m_size);
+                    m_size = _other.m_size;
+                    _other.clear();
+                    return;
+                }
+            }
+
+            adopt(_other.current_storage());
+            m_size = _other.m_size;
+            _other.adopt({});
+            _other.m_size = 0;
         }
 
-        const_reference_list front() const
+        void copy_from(const vector_base& _other)
         {
-            return ref_at(0);
+            if (m_capacity < _other.m_size)
+                adopt(allocate_storage(_other.m_size));
+
+            try
+            {
+                detail::copy_rows(_other.m_columns, _other.m_size, m_columns, column_sequence{});
+                count_copied(_other.m_size);
+            }
+            catch (...)
+            {
+                free_storage(current_storage());
+                adopt({});
+                throw;
+            }
+            m_size = _other.m_size;
         }
 
-        reference_list back()
+        size_type growth_capacity(size_type _required) const
         {
-            return ref_at(size() - 1);
+            return _required > 2 * m_capacity ? _required : 2 * m_capacity;
         }
 
-        const_reference_list back() const
+        void reallocate(size_type _capacity)
         {
-            return ref_at(size() - 1);
+            if (_capacity > m_capacity)
+            {
+                count_growth();
+                if (reallocate_in_place(_capacity))
+                    return;
+            }
+
+            storage newStorage{ allocate_storage(_capacity) };
+            try
+            {
+                relocate(newStorage, m_size, 0, column_sequence{});
+            }
+            catch (...)
+            {
+                free_storage(newStorage);
+                throw;
+            }
+            replace_storage(newStorage);
         }
 
-        void sort()
+        // When all the members are trivially copyable and the allocator can reallocate,
+        // the block is grown by the allocator (in place when possible, or with mremap for large blocks)
+        // and the columns are then moved to their new offsets, from the last one to the first one.
+        bool reallocate_in_place(size_type _capacity)
         {
+            if constexpr (can_reallocate)
+            {
+                if (m_block == nullptr)
+                    return false;
+
+                if (_capacity > max_size())
+                    throw length_error{ "soa::vector_base: capacity exceeds max_size()" };
+
+                // On failure the allocator leaves the block untouched, and the columns are moved to a new block as usual
+                block_unit* const block{ m_allocator.template reallocate<block_unit>(m_block, layout::units(m_capacity), layout::units(_capacity)) };
+                if (block == nullptr)
+                    return false;
+
+                const column_pointers from{ layout::columns(block, m_capacity) };
+                const column_pointers to{ layout::columns(block, _capacity) };
+                move_columns_backward(from, to, column_sequence{});
+                count_allocation(_capacity);
+                count_free();
+                count_moved(m_size);
+
+                adopt({ block, to, _capacity });
+                return true;
+            }
+            else
+            {
+                (void)_capacity;
+                return false;
+            }
         }
 
-    private:
+        // Column offsets only increase with the capacity, so moving the columns from the last one
+        // never overwrites a column which has not been moved yet
         template<size_t... I>
-        iterator begin_internal(index_sequence<I...>)
+        void move_columns_backward(const column_pointers& _from, const column_pointers& _to, index_sequence<I...>)
         {
-            return { get<static_cast<size_t>(I)>(m_soa).data()... };
+            constexpr size_t last{ members_layout::columns_count - 1 };
+            ((detail::move_bytes(get<last - I>(_from), m_size, get<last - I>(_to))), ...);
         }
 
-        template<size_t... I>
-        const_iterator begin_internal(index_sequence<I...>) const
+        // Constructs _count rows at _pos through _construct, growing the storage if needed.
+        // When a new block is required, the new rows are constructed before any existing row is relocated,
+        // so that _construct can safely read elements of this container.
+        template<typename Constructor>
+        void grow(size_type _required, size_type _pos, size_type _count, Constructor&& _construct)
         {
-            return { get<static_cast<size_t>(I)>(m_soa).data()... };
+            if (_required <= m_capacity)
+            {
+                _construct(m_columns, _pos, _count);
+                m_size += _count;
+                return;
+            }
+
+            count_growth();
+            storage newStorage{ allocate_storage(growth_capacity(_required)) };
+            try
+            {
+                _construct(newStorage.columns, _pos, _count);
+                try
+                {
+                    relocate(newStorage, _pos, _count, column_sequence{});
+                }
+                catch (...)
+                {
+                    detail::destroy_rows(newStorage.columns, _pos, _count, column_sequence{});
+                    throw;
+                }
+            }
+            catch (...)
+            {
+                free_storage(newStorage);
+                throw;
+            }
+            replace_storage(newStorage);
+            m_size += _count;
         }
 
-        template<size_t... I>
-        iterator end_internal(index_sequence<I...>)
+        void replace_storage(const storage& _storage)
         {
-            const size_type size{ this->size() };
-            return { get<static_cast<size_t>(I)>(m_soa).data() + size... };
+            detail::destroy_rows(m_columns, 0, m_size, column_sequence{});
+            free_storage(current_storage());
+            adopt(_storage);
         }
 
+        // Moves all the rows into _to, leaving _gapCount free rows at _gapPos.
+        // On exception, _to holds no constructed element.
         template<size_t... I>
-        const_iterator end_internal(index_sequence<I...>) const
+        void relocate(const storage& _to, size_type _gapPos, size_type _gapCount, index_sequence<I...> _sequence)
         {
-            const size_type size{ this->size() };
-            return { get<static_cast<size_t>(I)>(m_soa).data() + size... };
+            size_t relocated{};
+            try
+            {
+                ((relocate_column(get<I>(m_columns), m_size, get<I>(_to.columns), _gapPos, _gapCount), ++relocated), ...);
+            }
+            catch (...)
+            {
+                ((I < relocated ? destroy_column(get<I>(_to.columns), m_size, _gapPos, _gapCount) : void()), ...);
+                throw;
+            }
+            count_relocated(m_size, _sequence);
         }
 
-        template<typename Tuple, size_t... I>
-        void push_back_internal(Tuple&& _args, index_sequence<I...>)
+        template<typename T>
+        static void relocate_column(T* _from, size_type _count, T* _to, size_type _gapPos, size_type _gapCount)
         {
-            (get<I>(m_soa).push_back(get<I>(std::forward<Tuple>(_args))), ...);
+            detail::uninitialized_move_if_noexcept(_from, _gapPos, _to);
+            try
+            {
+                detail::uninitialized_move_if_noexcept(_from + _gapPos, _count - _gapPos, _to + _gapPos + _gapCount);
+            }
+            catch (...)
+            {
+                std::destroy_n(_to, _gapPos);
+                throw;
+            }
         }
 
-        template<typename Tuple, size_t... I>
-        void resize_internal(size_type _size, Tuple&& _args, index_sequence<I...>)
+        template<typename T>
+        static void destroy_column(T* _column, size_type _count, size_type _gapPos, size_type _gapCount)
         {
-            (get<I>(m_soa).resize(_size, get<I>(std::forward<Tuple>(_args))), ...);
+            std::destroy_n(_column, _gapPos);
+            std::destroy_n(_column + _gapPos + _gapCount, _count - _gapPos);
         }
 
-        template<typename Tuple, size_t... I>
-        void insert_internal(size_type _pos, Tuple&& _args, index_sequence<I...>)
+        // Statistics counters, which compile to nothing unless SOA_STATS is defined
+        void count_allocation(size_type _capacity)
         {
-            (get<I>(m_soa).insert(get<I>(m_soa).begin() + static_cast<ptrdiff_t>(_pos), get<I>(std::forward<Tuple>(_args))), ...);
+#ifdef SOA_STATS
+            ++m_stats.allocations;
+            m_stats.bytes_allocated += layout::units(_capacity) * sizeof(block_unit);
+            count_column_bytes(_capacity, column_sequence{});
+#else
+            (void)_capacity;
+#endif
         }
 
         template<size_t... I>
-        size_type erase_internal(size_type _startPos, size_type _endPos, index_sequence<I...>)
+        void count_column_bytes(size_type _capacity, index_sequence<I...>)
         {
-            (get<I>(m_soa).erase(get<I>(m_soa).begin() + static_cast<ptrdiff_t>(_startPos), get<I>(m_soa).begin() + static_cast<ptrdiff_t>(_endPos)), ...);
-            return _startPos;
+#ifdef SOA_STATS
+            ((m_stats.columns[I].bytes_allocated += layout::column_units(_capacity, sizeof(tuple_element_t<I, typename members_layout::columns>)) * layout::alignment), ...);
+#else
+            (void)_capacity;
+#endif
         }
 
-        template<typename ReturnType, size_t... I>
-        ReturnType at_internal(size_type _index, index_sequence<I...>)
+        void count_free()
         {
-            return forward_as_tuple(get<I>(m_soa).at(_index) ...);
+#ifdef SOA_STATS
+            ++m_stats.frees;
+#endif
         }
 
-        template<typename ReturnType, size_t... I>
-        ReturnType at_internal(size_type _index, index_sequence<I...>) const
+        void count_growth()
         {
-            return forward_as_tuple(get<I>(m_soa).at(_index) ...);
+#ifdef SOA_STATS
+            ++m_stats.growths;
+#endif
         }
 
-        template<typename T>
-        class allocator_wrapper
+        void count_moved(size_type _count)
         {
-            Allocator m_allocator;
-
-        public:
-            using value_type = T;
-            using pointer = T*;
-
-            allocator_wrapper(Allocator&& _allocator)
-                : m_allocator{ std::move(_allocator) }
-            {
-            }
-
-            allocator_wrapper(const allocator_wrapper&) = default;
-
-            template<typename U>
-            friend class allocator_wrapper;
-
-            template<typename U>
-            allocator_wrapper(const allocator_wrapper<U>& _other)
-                : m_allocator{ _other.m_allocator }
-            {
-            }
-
-            allocator_wrapper& operator=(const allocator_wrapper&) = default;
-
-            bool operator==(const allocator_wrapper& _other)
-            {
-                return this == &_other;
-            }
-
-            bool operator!=(const allocator_wrapper& _other)
-            {
-                return this != &_other;
-            }
+#ifdef SOA_STATS
+            for (auto& column : m_stats.columns)
+                column.moved += _count;
+#else
+            (void)_count;
+#endif
+        }
 
-            [[nodiscard]] pointer allocate(size_t _count)
-            {
-                return m_allocator.template allocate<T>(_count);
-            }
+        void count_copied(size_type _count)
+        {
+#ifdef SOA_STATS
+            for (auto& column : m_stats.columns)
+                column.copied += _count;
+#else
+            (void)_count;
+#endif
+        }
 
-            void deallocate(pointer _ptr, size_t /*_count*/)
-            {
-                m_allocator.template free<T>(_ptr);
-            }
-        };
+        // Relocated columns are moved, or copied when moving could throw (see detail::uninitialized_move_if_noexcept)
+        template<size_t... I>
+        void count_relocated(size_type _count, index_sequence<I...>)
+        {
+#ifdef SOA_STATS
+            ((detail::relocates_by_copy_v<tuple_element_t<I, typename members_layout::columns>> ? m_stats.columns[I].copied += _count : m_stats.columns[I].moved += _count), ...);
+#else
+            (void)_count;
+#endif
+        }
 
-        tuple<container<Types, allocator_wrapper<Types>>...> m_soa{ container<Types, allocator_wrapper<Types>>{ Allocator{} }... };
+        Allocator m_allocator{};
+        block_unit* m_block{};
+        column_pointers m_columns{};
+        size_type m_size{};
+        size_type m_capacity{};
+#ifdef SOA_STATS
+        stats_type m_stats{};
+#endif
     };
 
+    // Allocates blocks aligned on a cache line, or on the alignment of the type when it is larger.
+    // Except on Windows, a block is allocated with malloc with room for the alignment, the offset of the aligned
+    // address being stored just before it: reallocate can then use realloc, and move the elements back to an aligned
+    // address within the block when realloc moves them to a less aligned one, without any other allocation.
     struct std_allocator
     {
         template<typename T>
         static T* allocate(size_t _count)
         {
-            constexpr size_t cache_line_size{ 64 };
-            constexpr size_t alignment = alignof(T) > cache_line_size ? alignof(T) : cache_line_size;
+            constexpr size_t alignment = alignof(T) > detail::cache_line_size ? alignof(T) : detail::cache_line_size;
+            const size_t size{ (_count * sizeof(T) + alignment - 1) / alignment * alignment };
 
 #ifdef _WIN32
-            return static_cast<T*>(_aligned_malloc(_count * sizeof(T), alignment));
+            return static_cast<T*>(_aligned_malloc(size, alignment));
 #else
-            return static_cast<T*>(aligned_alloc(alignment, _count * sizeof(T)));
+            unsigned char* const block{ static_cast<unsigned char*>(malloc(size + alignment)) };
+            return block != nullptr ? reinterpret_cast<T*>(block + store_offset(block, alignment)) : nullptr;
 #endif
         }
 
@@ -781,11 +4041,89 @@ namespace soa
 #ifdef _WIN32
             _aligned_free(_ptr);
 #else
-            free(_ptr);
+            if (_ptr != nullptr)
+                soa::free(reinterpret_cast<unsigned char*>(_ptr) - stored_offset(_ptr));
 #endif
-    }
-};
+        }
+
+        // Grows a block returned by allocate, in place when possible. Returns nullptr when the block can't be grown,
+        // the original block being left untouched.
+        template<typename T>
+        static T* reallocate(T* _ptr, size_t _count, size_t _newCount)
+        {
+            constexpr size_t alignment = alignof(T) > detail::cache_line_size ? alignof(T) : detail::cache_line_size;
+            const size_t size{ (_newCount * sizeof(T) + alignment - 1) / alignment * alignment };
+
+#ifdef _WIN32
+            (void)_count;
+            return static_cast<T*>(_aligned_realloc(_ptr, size, alignment));
+#else
+            const size_t offset{ stored_offset(_ptr) };
+            unsigned char* const block{ static_cast<unsigned char*>(realloc(reinterpret_cast<unsigned char*>(_ptr) - offset, size + alignment)) };
+            if (block == nullptr)
+                return nullptr;
+
+            const size_t newOffset{ alignment - reinterpret_cast<uintptr_t>(block) % alignment };
+            if (newOffset != offset)
+                std::memmove(block + newOffset, block + offset, _count * sizeof(T));
+            return reinterpret_cast<T*>(block + store_offset(block, alignment));
+#endif
+        }
+
+    private:
+        // malloc aligns blocks for any fundamental type, leaving room for the offset before the aligned address
+        static_assert(alignof(std::max_align_t) >= sizeof(size_t), "The offset of a block must fit before its aligned address");
+
+        static size_t store_offset(unsigned char* _block, size_t _alignment)
+        {
+            const size_t offset{ _alignment - reinterpret_cast<uintptr_t>(_block) % _alignment };
+            std::memcpy(_block + offset - sizeof(size_t), &offset, sizeof(size_t));
+            return offset;
+        }
+
+        template<typename T>
+        static size_t stored_offset(const T* _ptr)
+        {
+            size_t offset{};
+            std::memcpy(&offset, reinterpret_cast<const unsigned char*>(_ptr) - sizeof(size_t), sizeof(size_t));
+            return offset;
+        }
+    };
 
     template<typename MembersDesc, typename... Types>
     using vector = soa::vector_base<MembersDesc, soa::std_allocator, Types...>;
 }
+
+namespace std
+{
+    template<typename... Refs>
+    struct tuple_size<soa::row_reference<Refs...>> : tuple_size<tuple<Refs...>>
+    {
+    };
+
+    template<size_t Index, typename... Refs>
+    struct tuple_element<Index, soa::row_reference<Refs...>> : tuple_element<Index, tuple<Refs...>>
+    {
+    };
+
+#if __cplusplus >= 202002L
+    // Common references between row references and their values, required by the C++20 iterator concepts
+    template<typename... Refs, typename... Values, template<typename> class RefsQual, template<typename> class ValuesQual>
+    struct basic_common_reference<soa::row_reference<Refs...>, tuple<Values...>, RefsQual, ValuesQual>
+    {
+        using type = soa::row_reference<const remove_reference_t<Refs>&...>;
+    };
+
+    template<typename... Values, typename... Refs, template<typename> class ValuesQual, template<typename> class RefsQual>
+    struct basic_common_reference<tuple<Values...>, soa::row_reference<Refs...>, ValuesQual, RefsQual>
+    {
+        using type = soa::row_reference<const remove_reference_t<Refs>&...>;
+    };
+
+    template<typename... Lhs, typename... Rhs, template<typename> class LhsQual, template<typename> class RhsQual>
+    struct basic_common_reference<soa::row_reference<Lhs...>, soa::row_reference<Rhs...>, LhsQual, RhsQual>
+    {
+        using type = soa::row_reference<const remove_reference_t<Lhs>&...>;
+    };
+#endif
+}
@@ -0,0 +1,707 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    namespace detail
+    {
+        // Layout of a tile of TileRows rows: the TileRows elements of each member are contiguous,
+        // and the members follow each other. Tiles start on a cache line boundary (or the member alignment when larger).
+        template<size_t TileRows, typename... Types>
+        struct tile_layout
+        {
+            static constexpr size_t alignment{ max_alignment<Types...>() };
+
+            struct alignas(alignment) unit
+            {
+                unsigned char bytes[alignment];
+            };
+
+            static constexpr array<size_t, sizeof...(Types)> offsets()
+            {
+                array<size_t, sizeof...(Types)> result{};
+                constexpr array<size_t, sizeof...(Types)> sizes{ sizeof(Types)... };
+                constexpr array<size_t, sizeof...(Types)> alignments{ alignof(Types)... };
+                size_t offset{};
+                for (size_t i = 0; i < sizeof...(Types); ++i)
+                {
+                    offset = (offset + alignments[i] - 1) / alignments[i] * alignments[i];
+                    result[i] = offset;
+                    offset += TileRows * sizes[i];
+                }
+                return result;
+            }
+
+            static constexpr array<size_t, sizeof...(Types)> member_offsets{ offsets() };
+
+            // Size of a tile, in bytes
+            static constexpr size_t stride{ (member_offsets.back() + TileRows * sizeof(tuple_element_t<sizeof...(Types) - 1, tuple<Types...>>) + alignment - 1) / alignment * alignment };
+
+            static constexpr size_t tiles(size_t _rows)
+            {
+                return (_rows + TileRows - 1) / TileRows;
+            }
+
+            static constexpr size_t units(size_t _rows)
+            {
+                return tiles(_rows) * (stride / alignment);
+            }
+
+            static constexpr size_t max_rows()
+            {
+                return std::numeric_limits<size_t>::max() / stride * TileRows;
+            }
+
+            template<size_t I>
+            static tuple_element_t<I, tuple<Types...>>* address(unit* _block, size_t _row)
+            {
+                unsigned char* tile{ reinterpret_cast<unsigned char*>(_block) + _row / TileRows * stride };
+                return reinterpret_cast<tuple_element_t<I, tuple<Types...>>*>(tile + member_offsets[I]) + _row % TileRows;
+            }
+        };
+    }
+
+    // Array of structures of arrays: the rows are stored in tiles of TileRows rows, each member being contiguous inside a tile.
+    // A kernel reading several members of a row then streams a single memory range instead of one range per member.
+    // The interface is the same as vector_base for the element access, push_back and the partial iterators,
+    // so both layouts can be compared by switching the container type. Like vector_base, all the tiles share a single block.
+    template <typename MembersDesc, typename Allocator, size_t TileRows, typename... Types>
+    class tiled_vector_base
+    {
+    public:
+        using size_type = size_t;
+        using value_list = tuple<Types...>;
+        using reference_list = tuple<Types&...>;
+        using const_reference_list = tuple<const Types&...>;
+
+        static constexpr size_t members_count{ sizeof...(Types) };
+        static_assert(members_count == static_cast<size_t>(MembersDesc::Count), "The MembersDesc enum must match the number of types");
+
+        static constexpr size_type tile_rows{ TileRows };
+        static_assert(TileRows != 0, "A tile must hold at least one row");
+        static_assert(!detail::member_layout<Types...>::has_groups, "Member groups are only supported by vector_base");
+
+        template<MembersDesc... Members>
+        using partial_ref_list = tuple<tuple_element_t<static_cast<size_t>(Members), value_list>&...>;
+
+        template<MembersDesc... Members>
+        using partial_const_ref_list = tuple<const tuple_element_t<static_cast<size_t>(Members), value_list>&...>;
+
+        template<MembersDesc Member>
+        using member_type = tuple_element_t<static_cast<size_t>(Member), value_list>;
+
+    private:
+        using layout = detail::tile_layout<TileRows, Types...>;
+        using block_unit = typename layout::unit;
+
+        // Addressing policy of the iterators, see detail::indexed_iterator: the table is the block pointer of the container
+        struct tile_addressing
+        {
+            using table = block_unit*;
+
+            template<size_t I>
+            using element_type = tuple_element_t<I, value_list>;
+
+            template<size_t I>
+            static element_type<I>* address(const table& _block, ptrdiff_t _index)
+            {
+                return layout::template address<I>(_block, static_cast<size_t>(_index));
+            }
+        };
+
+        template<template<MembersDesc...> typename Iterator, size_t... I>
+        static Iterator<static_cast<MembersDesc>(I)...> all_members(index_sequence<I...>);
+
+    public:
+        template<MembersDesc... Members>
+        using partial_iterator = detail::indexed_iterator<tile_addressing, false, MembersDesc, Members...>;
+
+        template<MembersDesc... Members>
+        using partial_const_iterator = detail::indexed_iterator<tile_addressing, true, MembersDesc, Members...>;
+
+        using iterator = decltype(all_members<partial_iterator>(make_index_sequence<members_count>{}));
+        using const_iterator = decltype(all_members<partial_const_iterator>(make_index_sequence<members_count>{}));
+
+        tiled_vector_base() = default;
+
+        explicit tiled_vector_base(Allocator _allocator)
+            : m_allocator{ std::move(_allocator) }
+        {
+        }
+
+        tiled_vector_base(const tiled_vector_base& _other)
+            : m_allocator{ _other.m_allocator }
+        {
+            copy_from(_other);
+        }
+
+        tiled_vector_base(tiled_vector_base&& _other) noexcept
+            : m_allocator{ std::move(_other.m_allocator) }
+        {
+            steal(_other);
+        }
+
+        ~tiled_vector_base()
+        {
+            clear();
+            free_block(m_block, m_capacity);
+        }
+
+        tiled_vector_base& operator=(const tiled_vector_base& _other)
+        {
+            if (this != &_other)
+            {
+                clear();
+                copy_from(_other);
+            }
+            return *this;
+        }
+
+        tiled_vector_base& operator=(tiled_vector_base&& _other)
+        {
+            if (this == &_other)
+                return *this;
+
+            // Same as vector_base: the block is transferred when the allocator propagates or both allocators are equal,
+            // otherwise the rows are moved into memory owned by this allocator.
+            clear();
+            if constexpr (detail::propagate_on_move_assignment_v<Allocator>)
+            {
+                free_block(m_block, m_capacity);
+                m_allocator = std::move(_other.m_allocator);
+                steal(_other);
+            }
+            else if constexpr (detail::is_always_equal_v<Allocator>)
+            {
+                free_block(m_block, m_capacity);
+                steal(_other);
+            }
+            else if (detail::allocators_equal(m_allocator, _other.m_allocator))
+            {
+                free_block(m_block, m_capacity);
+                steal(_other);
+            }
+            else
+            {
+                reserve(_other.m_size);
+                relocate_rows(_other.m_block, m_block, 0, _other.m_size, make_index_sequence<members_count>{});
+                m_size = _other.m_size;
+                _other.clear();
+            }
+            return *this;
+        }
+
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        size_type capacity() const
+        {
+            return m_capacity;
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        static constexpr size_type max_size()
+        {
+            constexpr size_type maxRows{ layout::max_rows() };
+            constexpr size_type maxIndex{ static_cast<size_type>(std::numeric_limits<ptrdiff_t>::max()) };
+            return maxRows < maxIndex ? maxRows : maxIndex;
+        }
+
+        // Number of tiles holding rows
+        size_type tile_count() const
+        {
+            return layout::tiles(m_size);
+        }
+
+        // Contiguous array of a member in a tile, holding TileRows rows except for the last tile
+        template<MembersDesc Member>
+        span<member_type<Member>> column(size_type _tile)
+        {
+            return { layout::template address<static_cast<size_t>(Member)>(m_block, _tile * TileRows), tile_size(_tile) };
+        }
+
+        template<MembersDesc Member>
+        span<const member_type<Member>> column(size_type _tile) const
+        {
+            return { layout::template address<static_cast<size_t>(Member)>(m_block, _tile * TileRows), tile_size(_tile) };
+        }
+
+        iterator begin()
+        {
+            return { &m_block, 0 };
+        }
+
+        iterator end()
+        {
+            return { &m_block, static_cast<ptrdiff_t>(m_size) };
+        }
+
+        const_iterator begin() const
+        {
+            return { &m_block, 0 };
+        }
+
+        const_iterator end() const
+        {
+            return { &m_block, static_cast<ptrdiff_t>(m_size) };
+        }
+
+        const_iterator cbegin() const
+        {
+            return begin();
+        }
+
+        const_iterator cend() const
+        {
+            return end();
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> begin()
+        {
+            return { &m_block, 0 };
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> end()
+        {
+            return { &m_block, static_cast<ptrdiff_t>(m_size) };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> begin() const
+        {
+            return { &m_block, 0 };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> end() const
+        {
+            return { &m_block, static_cast<ptrdiff_t>(m_size) };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> cbegin() const
+        {
+            return begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> cend() const
+        {
+            return end<Members...>();
+        }
+
+        void reserve(size_type _capacity)
+        {
+            if (_capacity > m_capacity)
+                reallocate(_capacity);
+        }
+
+        void shrink_to_fit()
+        {
+            if (layout::tiles(m_capacity) > layout::tiles(m_size))
+                reallocate(m_size);
+        }
+
+        void clear()
+        {
+            destroy_rows(m_block, 0, m_size, make_index_sequence<members_count>{});
+            m_size = 0;
+        }
+
+        template<typename... Args>
+        void push_back(Args&&... _args)
+        {
+            if constexpr (sizeof...(_args) == 1)
+            {
+                if constexpr (
+                    is_same_v<decay_t<Args>..., reference_list> ||
+                    is_same_v<decay_t<Args>..., const_reference_list> ||
+                    is_same_v<decay_t<Args>..., value_list>)
+                {
+                    push_back_internal(std::forward<Args>(_args)..., make_index_sequence<members_count>{});
+                }
+                else
+                {
+                    push_back_internal(forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+                }
+            }
+            else
+            {
+                push_back_internal(forward_as_tuple(std::forward<Args>(_args)...), make_index_sequence<members_count>{});
+            }
+        }
+
+        void pop_back()
+        {
+            destroy_rows(m_block, m_size - 1, m_size, make_index_sequence<members_count>{});
+            --m_size;
+        }
+
+        void resize(size_type _size)
+        {
+            resize_internal(_size, [](block_unit* _block, size_type _row, auto _sequence) {
+                value_construct_row(_block, _row, _sequence);
+            });
+        }
+
+        template<typename... Args>
+        void resize(size_type _size, Args&&... _args)
+        {
+            if constexpr (sizeof...(_args) == 1)
+            {
+                if constexpr (
+                    is_same_v<decay_t<Args>..., reference_list> ||
+                    is_same_v<decay_t<Args>..., const_reference_list> ||
+                    is_same_v<decay_t<Args>..., value_list>)
+                {
+                    resize_fill(_size, _args...);
+                }
+                else
+                {
+                    resize_fill(_size, forward_as_tuple(std::forward<Args>(_args)...));
+                }
+            }
+            else
+            {
+                resize_fill(_size, forward_as_tuple(std::forward<Args>(_args)...));
+            }
+        }
+
+        // Removes the row at _pos by moving the last row into it
+        size_type erase_unordered(size_type _pos)
+        {
+            erase_unordered_internal(_pos, make_index_sequence<members_count>{});
+            return _pos;
+        }
+
+        template<MembersDesc I>
+        auto& at(size_type _index)
+        {
+            check_index(_index);
+            return *layout::template address<static_cast<size_t>(I)>(m_block, _index);
+        }
+
+        template<MembersDesc I>
+        const auto& at(size_type _index) const
+        {
+            check_index(_index);
+            return *layout::template address<static_cast<size_t>(I)>(m_block, _index);
+        }
+
+        reference_list ref_at(size_type _index)
+        {
+            check_index(_index);
+            return *iterator{ &m_block, static_cast<ptrdiff_t>(_index) };
+        }
+
+        const_reference_list ref_at(size_type _index) const
+        {
+            check_index(_index);
+            return *const_iterator{ &m_block, static_cast<ptrdiff_t>(_index) };
+        }
+
+        value_list value_at(size_type _index) const
+        {
+            return ref_at(_index);
+        }
+
+        reference_list front()
+        {
+            return ref_at(0);
+        }
+
+        const_reference_list front() const
+        {
+            return ref_at(0);
+        }
+
+        reference_list back()
+        {
+            return ref_at(m_size - 1);
+        }
+
+        const_reference_list back() const
+        {
+            return ref_at(m_size - 1);
+        }
+
+    private:
+        size_type tile_size(size_type _tile) const
+        {
+            const size_type first{ _tile * TileRows };
+            return m_size - first < TileRows ? m_size - first : TileRows;
+        }
+
+        void check_index(size_type _index) const
+        {
+            if (_index >= m_size)
+                throw out_of_range{ "soa::tiled_vector_base: index out of range" };
+        }
+
+        size_type growth_capacity(size_type _required) const
+        {
+            return _required > 2 * m_capacity ? _required : 2 * m_capacity;
+        }
+
+        block_unit* allocate_block(size_type _capacity)
+        {
+            if (_capacity == 0)
+                return nullptr;
+
+            if (_capacity > max_size())
+                throw length_error{ "soa::tiled_vector_base: capacity exceeds max_size()" };
+
+            block_unit* block{ m_allocator.template allocate<block_unit>(layout::units(_capacity)) };
+            if (block == nullptr)
+                throw bad_alloc{};
+            return block;
+        }
+
+        void free_block(block_unit* _block, size_type _capacity)
+        {
+            if (_block != nullptr)
+                detail::free_block(m_allocator, _block, layout::units(_capacity));
+        }
+
+        // Replaces the block by _block, holding all the rows, and frees the previous one
+        void replace_block(block_unit* _block, size_type _capacity)
+        {
+            destroy_rows(m_block, 0, m_size, make_index_sequence<members_count>{});
+            free_block(m_block, m_capacity);
+            m_block = _block;
+            // The capacity is a whole number of tiles
+            m_capacity = layout::tiles(_capacity) * TileRows;
+        }
+
+        void reallocate(size_type _capacity)
+        {
+            block_unit* block{ allocate_block(_capacity) };
+            try
+            {
+                relocate_rows(m_block, block, 0, m_size, make_index_sequence<members_count>{});
+            }
+            catch (...)
+            {
+                free_block(block, _capacity);
+                throw;
+            }
+            replace_block(block, _capacity);
+        }
+
+        void copy_from(const tiled_vector_base& _other)
+        {
+            reserve(_other.m_size);
+            size_type row{};
+            try
+            {
+                for (; row < _other.m_size; ++row)
+                    copy_row(_other.m_block, row, make_index_sequence<members_count>{});
+            }
+            catch (...)
+            {
+                destroy_rows(m_block, 0, row, make_index_sequence<members_count>{});
+                throw;
+            }
+            m_size = _other.m_size;
+        }
+
+        void steal(tiled_vector_base& _other)
+        {
+            m_block = _other.m_block;
+            m_size = _other.m_size;
+            m_capacity = _other.m_capacity;
+            _other.m_block = nullptr;
+            _other.m_size = 0;
+            _other.m_capacity = 0;
+        }
+
+        template<typename Tuple, size_t... I>
+        void push_back_internal(Tuple&& _args, index_sequence<I...> _sequence)
+        {
+            if (m_size < m_capacity)
+            {
+                construct_row(m_block, m_size, std::forward<Tuple>(_args), _sequence);
+                ++m_size;
+                return;
+            }
+
+            // The new row is constructed in the new block before the existing rows are relocated,
+            // as the arguments may reference rows of this container
+            const size_type capacity{ growth_capacity(m_size + 1) };
+            block_unit* block{ allocate_block(capacity) };
+            try
+            {
+                construct_row(block, m_size, std::forward<Tuple>(_args), _sequence);
+                try
+                {
+                    relocate_rows(m_block, block, 0, m_size, _sequence);
+                }
+                catch (...)
+                {
+                    destroy_rows(block, m_size, m_size + 1, _sequence);
+                    throw;
+                }
+            }
+            catch (...)
+            {
+                free_block(block, capacity);
+                throw;
+            }
+            replace_block(block, capacity);
+            ++m_size;
+        }
+
+        template<typename Tuple>
+        void resize_fill(size_type _size, const Tuple& _values)
+        {
+            // The values may reference rows of this container: they are copied before a reallocation
+            if (_size > m_capacity)
+            {
+                const value_list values{ _values };
+                reserve(growth_capacity(_size));
+                resize_fill(_size, values);
+                return;
+            }
+
+            resize_internal(_size, [&_values](block_unit* _block, size_type _row, auto _sequence) {
+                construct_row(_block, _row, _values, _sequence);
+            });
+        }
+
+        // Constructs the new rows one by one through _construct. On exception, the size is unchanged.
+        template<typename Constructor>
+        void resize_internal(size_type _size, Constructor&& _construct)
+        {
+            if (_size <= m_size)
+            {
+                destroy_rows(m_block, _size, m_size, make_index_sequence<members_count>{});
+                m_size = _size;
+                return;
+            }
+
+            if (_size > m_capacity)
+                reserve(growth_capacity(_size));
+
+            size_type row{ m_size };
+            try
+            {
+                for (; row < _size; ++row)
+                    _construct(m_block, row, make_index_sequence<members_count>{});
+            }
+            catch (...)
+            {
+                destroy_rows(m_block, m_size, row, make_index_sequence<members_count>{});
+                throw;
+            }
+            m_size = _size;
+        }
+
+        template<size_t... I>
+        void erase_unordered_internal(size_type _pos, index_sequence<I...>)
+        {
+            const size_type last{ m_size - 1 };
+            if (_pos != last)
+                ((*layout::template address<I>(m_block, _pos) = std::move(*layout::template address<I>(m_block, last))), ...);
+            pop_back();
+        }
+
+        template<size_t... I>
+        void copy_row(block_unit* _from, size_type _row, index_sequence<I...> _sequence)
+        {
+            construct_row(m_block, _row, tuple<const Types&...>{ *layout::template address<I>(_from, _row)... }, _sequence);
+        }
+
+        template<typename Tuple, size_t... I>
+        static void construct_row(block_unit* _block, size_type _row, Tuple&& _args, index_sequence<I...> _sequence)
+        {
+            detail::construct_row(tuple<Types*...>{ layout::template address<I>(_block, _row)... }, 0, std::forward<Tuple>(_args), _sequence);
+        }
+
+        template<size_t... I>
+        static void value_construct_row(block_unit* _block, size_type _row, index_sequence<I...> _sequence)
+        {
+            detail::value_construct_rows(tuple<Types*...>{ layout::template address<I>(_block, _row)... }, 0, 1, _sequence);
+        }
+
+        // Moves the rows [_first, _last) of _from to the same rows of _to, tile by tile.
+        // On exception, _to holds no constructed element.
+        template<size_t... I>
+        static void relocate_rows(block_unit* _from, block_unit* _to, size_type _first, size_type _last, index_sequence<I...>)
+        {
+            size_t relocated{};
+            try
+            {
+                ((relocate_member<I>(_from, _to, _first, _last), ++relocated), ...);
+            }
+            catch (...)
+            {
+                ((I < relocated ? destroy_member<I>(_to, _first, _last) : void()), ...);
+                throw;
+            }
+        }
+
+        template<size_t I>
+        static void relocate_member(block_unit* _from, block_unit* _to, size_type _first, size_type _last)
+        {
+            size_type row{ _first };
+            try
+            {
+                while (row < _last)
+                {
+                    const size_type count{ chunk_size(row, _last) };
+                    detail::uninitialized_move_if_noexcept(layout::template address<I>(_from, row), count, layout::template address<I>(_to, row));
+                    row += count;
+                }
+            }
+            catch (...)
+            {
+                destroy_member<I>(_to, _first, row);
+                throw;
+            }
+        }
+
+        template<size_t... I>
+        static void destroy_rows(block_unit* _block, size_type _first, size_type _last, index_sequence<I...>)
+        {
+            (destroy_member<I>(_block, _first, _last), ...);
+        }
+
+        template<size_t I>
+        static void destroy_member(block_unit* _block, size_type _first, size_type _last)
+        {
+            if constexpr (!std::is_trivially_destructible_v<tuple_element_t<I, value_list>>)
+            {
+                while (_first < _last)
+                {
+                    const size_type count{ chunk_size(_first, _last) };
+                    std::destroy_n(layout::template address<I>(_block, _first), count);
+                    _first += count;
+                }
+            }
+        }
+
+        // Number of rows from _row to the end of its tile, or to _last
+        static size_type chunk_size(size_type _row, size_type _last)
+        {
+            const size_type tileEnd{ (_row / TileRows + 1) * TileRows };
+            return (tileEnd < _last ? tileEnd : _last) - _row;
+        }
+
+        Allocator m_allocator{};
+        block_unit* m_block{};
+        size_type m_size{};
+        size_type m_capacity{};
+    };
+
+    template<typename MembersDesc, typename... Types>
+    using tiled_vector = soa::tiled_vector_base<MembersDesc, soa::std_allocator, 16, Types...>;
+}
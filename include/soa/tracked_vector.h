@@ -0,0 +1,554 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    // Structure of arrays recording which rows of each member were modified, with a dirty bit per member and block of BlockRows rows,
+    // so that incremental consumers (uploads, replication, caches) only process the modified blocks: see for_each_dirty and clear_dirty.
+    // The rows are modified through the accessors of the container, which mark the blocks they give access to: at<Member>, ref_at,
+    // the mutable iterators (when a member is accessed through them) and column<Member>, which marks the whole column.
+    // Appending or inserting rows marks all their members, and the rows moved by insert and erase are marked as well.
+    // Removed rows are not reported: consumers compare the size. The const accessors and rows() don't mark anything.
+    // The marks of 64 blocks share a word: threads modifying the rows at once (parallel_for_each) must work on multiples of 64 blocks.
+    template <typename MembersDesc, typename Allocator, size_t BlockRows, typename... Types>
+    class tracked_vector_base
+    {
+    public:
+        using rows_type = vector_base<MembersDesc, Allocator, Types...>;
+        using size_type = typename rows_type::size_type;
+
+        using value_list = typename rows_type::value_list;
+        using reference_list = typename rows_type::reference_list;
+        using const_reference_list = typename rows_type::const_reference_list;
+
+        template<MembersDesc Member>
+        using member_type = typename rows_type::template member_type<Member>;
+
+        static constexpr size_t members_count{ rows_type::members_count };
+
+        static constexpr size_type block_rows{ BlockRows };
+        static_assert(BlockRows != 0 && (BlockRows & (BlockRows - 1)) == 0, "The number of rows of a block must be a power of 2");
+
+        using const_iterator = typename rows_type::const_iterator;
+
+        template<MembersDesc... Members>
+        using partial_const_iterator = typename rows_type::template partial_const_iterator<Members...>;
+
+    private:
+        using member_sequence = make_index_sequence<members_count>;
+
+        // A row per 64 blocks, holding a word of dirty bits per member
+        template<size_t>
+        using dirty_word = uint64_t;
+
+        template<size_t... I>
+        static vector_base<MembersDesc, Allocator, dirty_word<I>...> dirty_table_type(index_sequence<I...>);
+
+        using dirty_table = decltype(dirty_table_type(member_sequence{}));
+
+        static constexpr size_type block_shift()
+        {
+            size_type shift{};
+            while ((size_type{ 1 } << shift) < BlockRows)
+                ++shift;
+            return shift;
+        }
+
+        static constexpr size_type ms_blockShift{ block_shift() };
+
+    public:
+        // Mutable iterator of the rows, marking the blocks of the members accessed through it
+        template<typename BaseIterator, size_t... I>
+        class tracking_iterator
+        {
+        public:
+            using iterator_category = typename BaseIterator::iterator_category;
+            using difference_type = typename BaseIterator::difference_type;
+            using reference = typename BaseIterator::reference;
+            using value_type = typename BaseIterator::value_type;
+            using pointer = typename BaseIterator::pointer;
+
+            tracking_iterator() = default;
+
+            reference operator*() const
+            {
+                m_owner->template mark_row<I...>(m_row);
+                return *m_it;
+            }
+
+            reference operator[](difference_type _offset) const
+            {
+                return *(*this + _offset);
+            }
+
+            friend auto iter_move(const tracking_iterator& _it)
+            {
+                _it.m_owner->template mark_row<I...>(_it.m_row);
+                return iter_move(_it.m_it);
+            }
+
+            template<MembersDesc Member>
+            auto& value()
+            {
+                m_owner->template mark_row<static_cast<size_t>(Member)>(m_row);
+                return m_it.template value<Member>();
+            }
+
+            // Index of the row
+            size_type row() const
+            {
+                return m_row;
+            }
+
+            tracking_iterator& operator++()
+            {
+                ++m_it;
+                ++m_row;
+                return *this;
+            }
+
+            tracking_iterator operator++(int)
+            {
+                tracking_iterator previous{ *this };
+                ++*this;
+                return previous;
+            }
+
+            tracking_iterator& operator--()
+            {
+                --m_it;
+                --m_row;
+                return *this;
+            }
+
+            tracking_iterator operator--(int)
+            {
+                tracking_iterator previous{ *this };
+                --*this;
+                return previous;
+            }
+
+            tracking_iterator& operator+=(difference_type _offset)
+            {
+                m_it += _offset;
+                m_row += static_cast<size_type>(_offset);
+                return *this;
+            }
+
+            tracking_iterator& operator-=(difference_type _offset)
+            {
+                return *this += -_offset;
+            }
+
+            tracking_iterator operator+(difference_type _offset) const
+            {
+                tracking_iterator it{ *this };
+                return it += _offset;
+            }
+
+            friend tracking_iterator operator+(difference_type _offset, const tracking_iterator& _it)
+            {
+                return _it + _offset;
+            }
+
+            tracking_iterator operator-(difference_type _offset) const
+            {
+                tracking_iterator it{ *this };
+                return it -= _offset;
+            }
+
+            friend difference_type operator-(const tracking_iterator& _lhs, const tracking_iterator& _rhs)
+            {
+                return static_cast<difference_type>(_lhs.m_row - _rhs.m_row);
+            }
+
+            friend bool operator==(const tracking_iterator& _lhs, const tracking_iterator& _rhs)
+            {
+                return _lhs.m_row == _rhs.m_row;
+            }
+
+            friend bool operator!=(const tracking_iterator& _lhs, const tracking_iterator& _rhs)
+            {
+                return _lhs.m_row != _rhs.m_row;
+            }
+
+            friend bool operator<(const tracking_iterator& _lhs, const tracking_iterator& _rhs)
+            {
+                return _lhs.m_row < _rhs.m_row;
+            }
+
+            friend bool operator>(const tracking_iterator& _lhs, const tracking_iterator& _rhs)
+            {
+                return _lhs.m_row > _rhs.m_row;
+            }
+
+            friend bool operator<=(const tracking_iterator& _lhs, const tracking_iterator& _rhs)
+            {
+                return _lhs.m_row <= _rhs.m_row;
+            }
+
+            friend bool operator>=(const tracking_iterator& _lhs, const tracking_iterator& _rhs)
+            {
+                return _lhs.m_row >= _rhs.m_row;
+            }
+
+        private:
+            tracking_iterator(BaseIterator _it, tracked_vector_base* _owner, size_type _row)
+                : m_it{ _it }
+                , m_owner{ _owner }
+                , m_row{ _row }
+            {
+            }
+
+            BaseIterator m_it{};
+            tracked_vector_base* m_owner{};
+            size_type m_row{};
+
+            friend class tracked_vector_base;
+        };
+
+    private:
+        template<size_t... I>
+        static tracking_iterator<typename rows_type::iterator, I...> iterator_type(index_sequence<I...>);
+
+    public:
+        using iterator = decltype(iterator_type(member_sequence{}));
+
+        template<MembersDesc... Members>
+        using partial_iterator = tracking_iterator<typename rows_type::template partial_iterator<Members...>, static_cast<size_t>(Members)...>;
+
+        tracked_vector_base() = default;
+
+        explicit tracked_vector_base(Allocator _allocator)
+            : m_rows{ _allocator }
+            , m_dirty{ std::move(_allocator) }
+        {
+        }
+
+        size_type size() const
+        {
+            return m_rows.size();
+        }
+
+        size_type capacity() const
+        {
+            return m_rows.capacity();
+        }
+
+        bool empty() const
+        {
+            return m_rows.empty();
+        }
+
+        static constexpr size_type max_size()
+        {
+            return rows_type::max_size();
+        }
+
+        void reserve(size_type _capacity)
+        {
+            m_rows.reserve(_capacity);
+            m_dirty.reserve(word_count(_capacity));
+        }
+
+        void shrink_to_fit()
+        {
+            m_rows.shrink_to_fit();
+            m_dirty.resize(word_count(size()));
+            m_dirty.shrink_to_fit();
+        }
+
+        // Removes all the rows and their marks
+        void clear()
+        {
+            m_rows.clear();
+            m_dirty.clear();
+        }
+
+        template<typename... Args>
+        void push_back(Args&&... _args)
+        {
+            m_dirty.resize(word_count(size() + 1));
+            m_rows.push_back(std::forward<Args>(_args)...);
+            mark_range(size() - 1, size(), member_sequence{});
+        }
+
+        void pop_back()
+        {
+            m_rows.pop_back();
+        }
+
+        void resize(size_type _size)
+        {
+            m_dirty.resize(word_count(_size));
+            const size_type previous{ size() };
+            m_rows.resize(_size);
+            if (_size > previous)
+                mark_range(previous, _size, member_sequence{});
+        }
+
+        // Marks the inserted row and the rows moved after it
+        template<typename... Args>
+        void insert(size_type _pos, Args&&... _args)
+        {
+            m_dirty.resize(word_count(size() + 1));
+            m_rows.insert(_pos, std::forward<Args>(_args)...);
+            mark_range(_pos, size(), member_sequence{});
+        }
+
+        // Marks the rows moved into the erased ones
+        size_type erase(size_type _pos)
+        {
+            return erase(_pos, _pos + 1);
+        }
+
+        size_type erase(size_type _startPos, size_type _endPos)
+        {
+            const size_type next{ m_rows.erase(_startPos, _endPos) };
+            mark_range(_startPos, size(), member_sequence{});
+            return next;
+        }
+
+        // Marks the row moved into the erased one
+        size_type erase_unordered(size_type _pos)
+        {
+            const size_type next{ m_rows.erase_unordered(_pos) };
+            if (_pos < size())
+                mark_range(_pos, _pos + 1, member_sequence{});
+            return next;
+        }
+
+        // Marks the rows from the first erased one
+        template<MembersDesc... Members, typename Predicate>
+        size_type erase_if(Predicate _predicate)
+        {
+            size_type first{ size() };
+            size_type row{};
+            const size_type erased{ m_rows.template erase_if<Members...>([&](const auto&... _members) {
+                const bool erase{ _predicate(_members...) };
+                first = erase && row < first ? row : first;
+                ++row;
+                return erase;
+            }) };
+            if (first < size())
+                mark_range(first, size(), member_sequence{});
+            return erased;
+        }
+
+        template<MembersDesc Member>
+        auto& at(size_type _index)
+        {
+            auto& value{ m_rows.template at<Member>(_index) };
+            mark_row<static_cast<size_t>(Member)>(_index);
+            return value;
+        }
+
+        template<MembersDesc Member>
+        const auto& at(size_type _index) const
+        {
+            return m_rows.template at<Member>(_index);
+        }
+
+        reference_list ref_at(size_type _index)
+        {
+            reference_list refs{ m_rows.ref_at(_index) };
+            mark_range(_index, _index + 1, member_sequence{});
+            return refs;
+        }
+
+        const_reference_list ref_at(size_type _index) const
+        {
+            return m_rows.ref_at(_index);
+        }
+
+        value_list value_at(size_type _index) const
+        {
+            return m_rows.value_at(_index);
+        }
+
+        iterator begin()
+        {
+            return { m_rows.begin(), this, 0 };
+        }
+
+        iterator end()
+        {
+            return { m_rows.end(), this, size() };
+        }
+
+        const_iterator begin() const
+        {
+            return m_rows.begin();
+        }
+
+        const_iterator end() const
+        {
+            return m_rows.end();
+        }
+
+        const_iterator cbegin() const
+        {
+            return m_rows.cbegin();
+        }
+
+        const_iterator cend() const
+        {
+            return m_rows.cend();
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> begin()
+        {
+            return { m_rows.template begin<Members...>(), this, 0 };
+        }
+
+        template<MembersDesc... Members>
+        partial_iterator<Members...> end()
+        {
+            return { m_rows.template end<Members...>(), this, size() };
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> begin() const
+        {
+            return m_rows.template begin<Members...>();
+        }
+
+        template<MembersDesc... Members>
+        partial_const_iterator<Members...> end() const
+        {
+            return m_rows.template end<Members...>();
+        }
+
+        // Marks the whole column: prefer at or the iterators to mark only the modified rows, or mark_dirty after writing to the column
+        template<MembersDesc Member>
+        span<member_type<Member>> column()
+        {
+            mark_range(0, size(), index_sequence<static_cast<size_t>(Member)>{});
+            return m_rows.template column<Member>();
+        }
+
+        template<MembersDesc Member>
+        span<const member_type<Member>> column() const
+        {
+            return m_rows.template column<Member>();
+        }
+
+        // Read only access to the rows, for the other algorithms of vector_base (slices, selections, reductions...)
+        const rows_type& rows() const
+        {
+            return m_rows;
+        }
+
+        // Marks the rows [_first, _last) of the given members, or of all the members when none is given
+        template<MembersDesc... Members>
+        void mark_dirty(size_type _first, size_type _last)
+        {
+            mark_range(_first, _last < size() ? _last : size(), members_or_all<Members...>{});
+        }
+
+        // Whether the block of the row is marked for the member
+        template<MembersDesc Member>
+        bool is_dirty(size_type _row) const
+        {
+            const size_type block{ _row >> ms_blockShift };
+            return (m_dirty.template column<Member>()[block / 64] >> (block % 64)) & 1;
+        }
+
+        // Calls _function(first, last) for each range of consecutive rows in blocks marked for any of the given members
+        // (or of all the members when none is given), in increasing order. Only the words of 64 blocks with a mark are looked at.
+        template<MembersDesc... Members, typename Function>
+        void for_each_dirty(Function _function) const
+        {
+            for_each_dirty_internal(_function, members_or_all<Members...>{});
+        }
+
+        // Clears the marks of the given members, or of all the members when none is given
+        template<MembersDesc... Members>
+        void clear_dirty()
+        {
+            clear_dirty_internal(members_or_all<Members...>{});
+        }
+
+    private:
+        template<MembersDesc... Members>
+        using members_or_all = std::conditional_t<sizeof...(Members) == 0, member_sequence, index_sequence<static_cast<size_t>(Members)...>>;
+
+        static size_type word_count(size_type _rows)
+        {
+            const size_type blocks{ (_rows + BlockRows - 1) >> ms_blockShift };
+            return (blocks + 63) / 64;
+        }
+
+        template<size_t... I>
+        void mark_row(size_type _row)
+        {
+            const size_type block{ _row >> ms_blockShift };
+            const uint64_t bit{ uint64_t{ 1 } << (block % 64) };
+            ((m_dirty.template column<static_cast<MembersDesc>(I)>()[block / 64] |= bit), ...);
+        }
+
+        template<size_t... I>
+        void mark_range(size_type _first, size_type _last, index_sequence<I...>)
+        {
+            if (_first >= _last)
+                return;
+
+            const size_type firstBlock{ _first >> ms_blockShift };
+            const size_type lastBlock{ (_last - 1) >> ms_blockShift };
+            for (size_type word = firstBlock / 64; word <= lastBlock / 64; ++word)
+            {
+                const size_type first{ word == firstBlock / 64 ? firstBlock % 64 : 0 };
+                const size_type last{ word == lastBlock / 64 ? lastBlock % 64 : 63 };
+                const uint64_t bits{ (~uint64_t{} >> (63 - last)) & (~uint64_t{} << first) };
+                ((m_dirty.template column<static_cast<MembersDesc>(I)>()[word] |= bits), ...);
+            }
+        }
+
+        template<typename Function, size_t... I>
+        void for_each_dirty_internal(Function& _function, index_sequence<I...>) const
+        {
+            const size_type rows{ size() };
+            const size_type words{ word_count(rows) };
+            size_type rangeFirst{};
+            size_type rangeLast{};
+            for (size_type word = 0; word < words; ++word)
+            {
+                uint64_t bits{ (m_dirty.template column<static_cast<MembersDesc>(I)>()[word] | ...) };
+                while (bits != 0)
+                {
+                    const size_type bit{ detail::countr_zero(bits) };
+                    bits &= bits - 1;
+
+                    const size_type first{ (word * 64 + bit) << ms_blockShift };
+                    if (first >= rows)
+                        break;
+
+                    const size_type last{ rows - first < BlockRows ? rows : first + BlockRows };
+                    if (first != rangeLast)
+                    {
+                        if (rangeFirst != rangeLast)
+                            _function(rangeFirst, rangeLast);
+                        rangeFirst = first;
+                    }
+                    rangeLast = last;
+                }
+            }
+            if (rangeFirst != rangeLast)
+                _function(rangeFirst, rangeLast);
+        }
+
+        template<size_t... I>
+        void clear_dirty_internal(index_sequence<I...>)
+        {
+            (std::fill_n(m_dirty.template column<static_cast<MembersDesc>(I)>().data(), m_dirty.size(), uint64_t{}), ...);
+        }
+
+        rows_type m_rows;
+        dirty_table m_dirty;
+    };
+
+    template<typename MembersDesc, typename... Types>
+    using tracked_vector = soa::tracked_vector_base<MembersDesc, soa::std_allocator, 64, Types...>;
+}
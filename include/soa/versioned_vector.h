@@ -0,0 +1,441 @@
+#pragma once
+
+#include "soa.h"
+
+namespace soa
+{
+    namespace detail
+    {
+        // Rows of a column of a versioned_vector, shared by the versions of the column, and never modified while shared.
+        // The last version releasing the chunk destroys its rows.
+        template<typename T, size_t Rows>
+        struct shared_chunk
+        {
+            std::atomic<size_t> references{ 1 };
+            size_t size{};
+            alignas(T) unsigned char storage[sizeof(T) * Rows];
+
+            T* rows()
+            {
+                return reinterpret_cast<T*>(storage);
+            }
+
+            const T* rows() const
+            {
+                return reinterpret_cast<const T*>(storage);
+            }
+        };
+    }
+
+    // Structure of arrays handing out snapshots of its rows to other threads: each column is stored in chunks of ChunkRows rows,
+    // shared by reference counting between the container and its snapshots. A snapshot, returned by snapshot(), copies the tables
+    // of chunk pointers, and stays unchanged while the container is modified: the container copies a chunk of a column before
+    // modifying it when the chunk is shared, so that the cost of the copies is proportional to the modified chunks and columns.
+    // The snapshots are read by any number of threads without any lock, and released from any thread, which needs a thread safe
+    // allocator. The container itself is modified by a single thread. Copying the container also shares the chunks.
+    template <typename MembersDesc, typename Allocator, size_t ChunkRows, typename... Types>
+    class versioned_vector_base
+    {
+    public:
+        using size_type = size_t;
+        using value_list = tuple<Types...>;
+
+        static constexpr size_t members_count{ sizeof...(Types) };
+        static_assert(members_count == static_cast<size_t>(MembersDesc::Count), "The MembersDesc enum must match the number of types");
+
+        static constexpr size_type chunk_rows{ ChunkRows };
+        static_assert(ChunkRows != 0 && (ChunkRows & (ChunkRows - 1)) == 0, "The number of rows of a chunk must be a power of 2");
+        static_assert(!detail::member_layout<Types...>::has_groups, "Member groups are only supported by vector_base");
+
+        template<MembersDesc Member>
+        using member_type = tuple_element_t<static_cast<size_t>(Member), value_list>;
+
+    private:
+        template<typename T>
+        using chunk = detail::shared_chunk<T, ChunkRows>;
+
+        // A row per chunk index, holding the chunk of each column
+        using chunk_table = vector_base<MembersDesc, Allocator, chunk<Types>*...>;
+        using member_sequence = make_index_sequence<members_count>;
+
+        static constexpr size_type chunk_shift()
+        {
+            size_type shift{};
+            while ((size_type{ 1 } << shift) < ChunkRows)
+                ++shift;
+            return shift;
+        }
+
+        static constexpr size_type ms_chunkShift{ chunk_shift() };
+        static constexpr size_type ms_chunkMask{ ChunkRows - 1 };
+
+    public:
+        // Immutable rows of the container at the time of the snapshot. Copying a version shares its chunks.
+        class version
+        {
+        public:
+            version() = default;
+
+            version(const version& _other)
+                : m_chunks{ _other.m_chunks }
+                , m_size{ _other.m_size }
+            {
+                acquire_chunks(m_chunks, member_sequence{});
+            }
+
+            version(version&& _other) noexcept
+                : m_chunks{ std::move(_other.m_chunks) }
+                , m_size{ std::exchange(_other.m_size, 0) }
+            {
+            }
+
+            version& operator=(version _other) noexcept
+            {
+                swap(m_chunks, _other.m_chunks);
+                std::swap(m_size, _other.m_size);
+                return *this;
+            }
+
+            ~version()
+            {
+                release_chunks(m_chunks, 0, member_sequence{});
+            }
+
+            size_type size() const
+            {
+                return m_size;
+            }
+
+            bool empty() const
+            {
+                return m_size == 0;
+            }
+
+            size_type chunk_count() const
+            {
+                return m_chunks.size();
+            }
+
+            template<MembersDesc Member>
+            const member_type<Member>& at(size_type _index) const
+            {
+                if (_index >= m_size)
+                    throw out_of_range{ "soa::versioned_vector::version: index out of range" };
+                return chunk_of<Member>(m_chunks, _index >> ms_chunkShift)->rows()[_index & ms_chunkMask];
+            }
+
+            // Rows of a member in a chunk, ChunkRows rows except for the last chunk
+            template<MembersDesc Member>
+            span<const member_type<Member>> column(size_type _chunk) const
+            {
+                return { chunk_of<Member>(m_chunks, _chunk)->rows(), chunk_size(m_size, _chunk) };
+            }
+
+            // Calls _function with the given members of each row (all the members when none is given)
+            template<MembersDesc... Members, typename Function>
+            void for_each(Function _function) const
+            {
+                if constexpr (sizeof...(Members) == 0)
+                    for_each_internal(_function, member_sequence{});
+                else
+                    for_each_internal(_function, index_sequence<static_cast<size_t>(Members)...>{});
+            }
+
+        private:
+            version(const chunk_table& _chunks, size_type _size)
+                : m_chunks{ _chunks }
+                , m_size{ _size }
+            {
+                acquire_chunks(m_chunks, member_sequence{});
+            }
+
+            template<typename Function, size_t... I>
+            void for_each_internal(Function& _function, index_sequence<I...>) const
+            {
+                for (size_type chunkIndex = 0; chunkIndex < m_chunks.size(); ++chunkIndex)
+                {
+                    const size_type rows{ chunk_size(m_size, chunkIndex) };
+                    apply([&_function, rows](const auto*... _columns) {
+                        for (size_type row = 0; row < rows; ++row)
+                            _function(_columns[row]...);
+                    }, tuple<const tuple_element_t<I, value_list>*...>{ chunk_of<static_cast<MembersDesc>(I)>(m_chunks, chunkIndex)->rows()... });
+                }
+            }
+
+            chunk_table m_chunks;
+            size_type m_size{};
+
+            friend class versioned_vector_base;
+        };
+
+        versioned_vector_base() = default;
+
+        explicit versioned_vector_base(Allocator _allocator)
+            : m_chunks{ std::move(_allocator) }
+        {
+        }
+
+        versioned_vector_base(const versioned_vector_base& _other)
+            : m_chunks{ _other.m_chunks }
+            , m_size{ _other.m_size }
+        {
+            acquire_chunks(m_chunks, member_sequence{});
+        }
+
+        versioned_vector_base(versioned_vector_base&& _other) noexcept
+            : m_chunks{ std::move(_other.m_chunks) }
+            , m_size{ std::exchange(_other.m_size, 0) }
+        {
+        }
+
+        versioned_vector_base& operator=(versioned_vector_base _other) noexcept
+        {
+            swap(m_chunks, _other.m_chunks);
+            std::swap(m_size, _other.m_size);
+            return *this;
+        }
+
+        ~versioned_vector_base()
+        {
+            release_chunks(m_chunks, 0, member_sequence{});
+        }
+
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        size_type chunk_count() const
+        {
+            return m_chunks.size();
+        }
+
+        // Immutable view of the current rows, to be handed to other threads
+        version snapshot() const
+        {
+            return version{ m_chunks, m_size };
+        }
+
+        template<typename... Args>
+        void push_back(Args&&... _args)
+        {
+            static_assert(sizeof...(Args) == members_count, "push_back takes the values of all the members");
+
+            // The last chunk is copied when shared, so that the versions sharing it can still be released from other threads
+            const size_type chunkIndex{ m_size >> ms_chunkShift };
+            const bool newChunk{ chunkIndex == m_chunks.size() };
+            if (newChunk)
+                add_chunks(member_sequence{});
+            else
+                unshare_chunks(chunkIndex, member_sequence{});
+
+            try
+            {
+                construct_row(chunkIndex, m_size & ms_chunkMask, forward_as_tuple(std::forward<Args>(_args)...), member_sequence{});
+            }
+            catch (...)
+            {
+                if (newChunk)
+                {
+                    release_chunks(m_chunks, chunkIndex, member_sequence{});
+                    m_chunks.pop_back();
+                }
+                throw;
+            }
+            ++m_size;
+        }
+
+        void pop_back()
+        {
+            const size_type chunkIndex{ (m_size - 1) >> ms_chunkShift };
+            unshare_chunks(chunkIndex, member_sequence{});
+            destroy_last_row(chunkIndex, member_sequence{});
+            --m_size;
+            if ((m_size & ms_chunkMask) == 0)
+            {
+                release_chunks(m_chunks, chunkIndex, member_sequence{});
+                m_chunks.pop_back();
+            }
+        }
+
+        void clear()
+        {
+            release_chunks(m_chunks, 0, member_sequence{});
+            m_chunks.clear();
+            m_size = 0;
+        }
+
+        // Modifiable member: its chunk is copied first when a version shares it
+        template<MembersDesc Member>
+        member_type<Member>& at(size_type _index)
+        {
+            if (_index >= m_size)
+                throw out_of_range{ "soa::versioned_vector: index out of range" };
+            return unshare_chunk<static_cast<size_t>(Member)>(_index >> ms_chunkShift)->rows()[_index & ms_chunkMask];
+        }
+
+        template<MembersDesc Member>
+        const member_type<Member>& at(size_type _index) const
+        {
+            if (_index >= m_size)
+                throw out_of_range{ "soa::versioned_vector: index out of range" };
+            return chunk_of<Member>(m_chunks, _index >> ms_chunkShift)->rows()[_index & ms_chunkMask];
+        }
+
+        // Rows of a member in a chunk, copied first when a version shares them
+        template<MembersDesc Member>
+        span<member_type<Member>> column(size_type _chunk)
+        {
+            return { unshare_chunk<static_cast<size_t>(Member)>(_chunk)->rows(), chunk_size(m_size, _chunk) };
+        }
+
+        template<MembersDesc Member>
+        span<const member_type<Member>> column(size_type _chunk) const
+        {
+            return { chunk_of<Member>(m_chunks, _chunk)->rows(), chunk_size(m_size, _chunk) };
+        }
+
+    private:
+        static size_type chunk_size(size_type _size, size_type _chunk)
+        {
+            const size_type first{ _chunk << ms_chunkShift };
+            return _size - first < ChunkRows ? _size - first : ChunkRows;
+        }
+
+        template<MembersDesc Member>
+        static const chunk<member_type<Member>>* chunk_of(const chunk_table& _chunks, size_type _chunk)
+        {
+            return _chunks.template column<Member>()[_chunk];
+        }
+
+        template<size_t... I>
+        static void acquire_chunks(const chunk_table& _chunks, index_sequence<I...>)
+        {
+            for (size_type chunkIndex = 0; chunkIndex < _chunks.size(); ++chunkIndex)
+                (_chunks.template column<static_cast<MembersDesc>(I)>()[chunkIndex]->references.fetch_add(1, std::memory_order_relaxed), ...);
+        }
+
+        // Releases the chunks from _first, the last owner of a chunk destroying it
+        template<size_t... I>
+        static void release_chunks(chunk_table& _chunks, size_type _first, index_sequence<I...>)
+        {
+            Allocator allocator{ _chunks.get_allocator() };
+            for (size_type chunkIndex = _first; chunkIndex < _chunks.size(); ++chunkIndex)
+                (release_chunk(allocator, _chunks.template column<static_cast<MembersDesc>(I)>()[chunkIndex]), ...);
+        }
+
+        template<typename T>
+        static void release_chunk(Allocator& _allocator, chunk<T>* _chunk)
+        {
+            if (_chunk->references.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+
+            std::destroy_n(_chunk->rows(), _chunk->size);
+            std::destroy_at(_chunk);
+            detail::free_block(_allocator, _chunk, 1);
+        }
+
+        template<typename T>
+        chunk<T>* allocate_chunk()
+        {
+            Allocator allocator{ m_chunks.get_allocator() };
+            chunk<T>* block{ allocator.template allocate<chunk<T>>(1) };
+            if (block == nullptr)
+                throw bad_alloc{};
+            return ::new (static_cast<void*>(block)) chunk<T>;
+        }
+
+        template<typename T>
+        void free_chunk(chunk<T>* _chunk)
+        {
+            Allocator allocator{ m_chunks.get_allocator() };
+            std::destroy_at(_chunk);
+            detail::free_block(allocator, _chunk, 1);
+        }
+
+        // Chunk of a column which isn't shared with any version: this container being its only owner, no version can acquire it
+        // meanwhile, and the acquire load orders the reads of the versions which released it before its modification
+        template<size_t I>
+        auto* unshare_chunk(size_type _chunk)
+        {
+            using T = tuple_element_t<I, value_list>;
+            chunk<T>*& current{ m_chunks.template column<static_cast<MembersDesc>(I)>()[_chunk] };
+            if (current->references.load(std::memory_order_acquire) == 1)
+                return current;
+
+            chunk<T>* copy{ allocate_chunk<T>() };
+            try
+            {
+                std::uninitialized_copy_n(current->rows(), current->size, copy->rows());
+            }
+            catch (...)
+            {
+                free_chunk(copy);
+                throw;
+            }
+            copy->size = current->size;
+
+            Allocator allocator{ m_chunks.get_allocator() };
+            release_chunk(allocator, current);
+            current = copy;
+            return current;
+        }
+
+        template<size_t... I>
+        void unshare_chunks(size_type _chunk, index_sequence<I...>)
+        {
+            (unshare_chunk<I>(_chunk), ...);
+        }
+
+        template<size_t... I>
+        void add_chunks(index_sequence<I...>)
+        {
+            tuple<chunk<Types>*...> chunks{};
+            try
+            {
+                ((get<I>(chunks) = allocate_chunk<Types>()), ...);
+                m_chunks.push_back(get<I>(chunks)...);
+            }
+            catch (...)
+            {
+                ((get<I>(chunks) != nullptr ? free_chunk(get<I>(chunks)) : void()), ...);
+                throw;
+            }
+        }
+
+        template<typename Tuple, size_t... I>
+        void construct_row(size_type _chunk, size_type _row, Tuple&& _args, index_sequence<I...>)
+        {
+            const tuple<chunk<Types>*...> chunks{ m_chunks.template column<static_cast<MembersDesc>(I)>()[_chunk]... };
+            size_t constructed{};
+            try
+            {
+                ((::new (static_cast<void*>(get<I>(chunks)->rows() + _row)) tuple_element_t<I, value_list>(get<I>(std::forward<Tuple>(_args))), ++constructed), ...);
+            }
+            catch (...)
+            {
+                ((I < constructed ? std::destroy_at(get<I>(chunks)->rows() + _row) : void()), ...);
+                throw;
+            }
+            (++get<I>(chunks)->size, ...);
+        }
+
+        template<size_t... I>
+        void destroy_last_row(size_type _chunk, index_sequence<I...>)
+        {
+            const tuple<chunk<Types>*...> chunks{ m_chunks.template column<static_cast<MembersDesc>(I)>()[_chunk]... };
+            (std::destroy_at(get<I>(chunks)->rows() + --get<I>(chunks)->size), ...);
+        }
+
+        chunk_table m_chunks;
+        size_type m_size{};
+    };
+
+    template<typename MembersDesc, typename... Types>
+    using versioned_vector = soa::versioned_vector_base<MembersDesc, soa::std_allocator, 1024, Types...>;
+}
@@ -1,9 +1,25 @@
 
 #include "soa/soa.h"
+#include "soa/allocators.h"
+#include "soa/flat_map.h"
+#include "soa/indexed_vector.h"
+#include "soa/parallel.h"
+#include "soa/reduce.h"
+#include "soa/segmented_vector.h"
+#include "soa/sharded_vector.h"
+#include "soa/slot_map.h"
+#include "soa/small_vector.h"
+#include "soa/tiled_vector.h"
+#include "soa/tracked_vector.h"
+#include "soa/versioned_vector.h"
 
 #include <algorithm>
 #include <assert.h>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 
 // Demo purpose position type
@@ -64,6 +80,55 @@ enum class Example
 // and the list of members types, that must match your enum
 using ExampleArray = soa::vector<Example, vector3, int, float, std::string, Checker>;
 
+// The same structure stored in fixed size segments, which are never reallocated
+using ExampleSegments = soa::segmented_vector<Example, vector3, int, float, std::string, Checker>;
+
+// Or in tiles of 16 rows, each member being contiguous inside a tile (array of structures of arrays)
+using ExampleTiles = soa::tiled_vector<Example, vector3, int, float, std::string, Checker>;
+
+// Small tables can keep their rows inside the object: up to 32 rows without any heap allocation,
+// or up to 8 rows inline before moving to the heap
+using ExampleStatic = soa::static_vector<Example, 32, vector3, int, float, std::string, Checker>;
+using ExampleSmall = soa::small_vector<Example, 8, vector3, int, float, std::string, Checker>;
+
+// Rows referenced by handles which stay valid while the other rows are erased, the rows staying packed
+using ExampleSlots = soa::slot_map<Example, vector3, int, float, std::string, Checker>;
+
+// Rows found from the value of a member in constant time, through a hash index maintained by the container
+using ExampleIndexed = soa::indexed_vector<Example, Example::NumItems, vector3, int, float, std::string, Checker>;
+
+// Or kept sorted on a unique key member, searched with binary searches on the key column only
+using ExampleSorted = soa::flat_map<Example, Example::NumItems, vector3, int, float, std::string, Checker>;
+
+// Or in reference counted chunks of each column, shared with the snapshots handed to other threads
+using ExampleVersions = soa::versioned_vector<Example, vector3, int, float, std::string, Checker>;
+
+// Or recording the blocks of 64 rows modified in each column, for consumers processing only the changes
+using ExampleTracked = soa::tracked_vector<Example, vector3, int, float, std::string, Checker>;
+
+// Members often accessed together can be grouped: Position and NumItems are then interleaved in a single column,
+// while the other members keep their own column. The enum still lists every member.
+using ExampleGrouped = soa::vector<Example, soa::group<vector3, int>, float, std::string, Checker>;
+
+// Rows appended by several threads: concurrent appends need members which are moved without exceptions
+enum class Event
+{
+    Time,
+    Source,
+    Count
+};
+using EventArray = soa::vector<Event, double, int>;
+
+// Sort keys of several kinds, Row being the index of the row before sorting
+enum class Sample
+{
+    Value,
+    Key,
+    Row,
+    Count
+};
+using SampleArray = soa::vector<Sample, float, int64_t, int>;
+
 class AllocatorInterface
 {
 public:
@@ -76,6 +141,7 @@ class ActualAllocator : public AllocatorInterface
 {
     void* allocate(size_t _size, size_t /*_align*/) override
     {
+        ++m_allocations;
         m_allocated += _size;
         return new char[_size];
     }
@@ -86,6 +152,7 @@ class ActualAllocator : public AllocatorInterface
     }
 
 public:
+    size_t m_allocations{};
     size_t m_allocated{};
 };
 
@@ -115,6 +182,9 @@ public:
 };
 using ExampleCustomAllocator = soa::vector_base<Example, PolymorphicAllocator, vector3, int, float, std::string, Checker>;
 
+// Or with one of the bundled allocators: soa::arena_allocator, soa::pool_allocator or soa::pmr_allocator
+using ExampleArenaArray = soa::vector_base<Example, soa::arena_allocator, vector3, int, float, std::string, Checker>;
+
 int main()
 {
     // Create an empty SOA with default construction
@@ -132,6 +202,11 @@ int main()
         ExampleCustomAllocator testCustom{ 10, { vector3{ 0.f, 0.f, 0.f }, 12, 13.f, std::string{ "init" }, Checker{} }, allocator };
         assert(testCustom.size() == 10);
         assert(allocator.m_allocated > 0);
+
+        // All the members are stored in a single memory block, so growing the vector is a single allocation
+        assert(allocator.m_allocations == 1);
+        testCustom.reserve(20);
+        assert(allocator.m_allocations == 2);
     }
 
     // Interface is similar to std::vector
@@ -216,6 +291,29 @@ int main()
     test.pop_back();
     assert(test.size() == 4);
 
+    // When the order of the rows doesn't matter, erase_unordered moves the last row into the erased one
+    test.push_back(vector3{}, 21, 0.f, "removed", Checker{});
+    test.push_back(vector3{}, 22, 0.f, "last", Checker{});
+    test.erase_unordered(test.size() - 2);
+    assert(test.size() == 5 && test.at<Example::NumItems>(4) == 22);
+
+    // Several rows can be erased in a single pass, from a predicate on some members (or all of them),
+    // preserving the order of the other rows or not
+    size_t erasedCount = test.erase_if<Example::Name>([](const std::string& _name) { return _name == "last"; });
+    assert(erasedCount == 1 && test.size() == 4);
+    const std::vector<std::string> keptNames{ test.column<Example::Name>().begin(), test.column<Example::Name>().end() };
+    test.push_back(vector3{}, -1, -1.f, "erased", Checker{});
+    test.push_back(vector3{}, 100, -1.f, "kept", Checker{});
+    test.push_back(vector3{}, -2, -1.f, "erased", Checker{});
+    test.push_back(vector3{}, 101, 0.f, "kept", Checker{});
+    test.push_back(vector3{}, -3, -1.f, "erased", Checker{});
+    erasedCount = test.erase_if_unordered<Example::NumItems, Example::Life>([](int _numItems, float _life) { return _numItems < 0 && _life < 0.f; });
+    assert(erasedCount == 3 && test.size() == 6);
+    assert(std::equal(keptNames.begin(), keptNames.end(), test.column<Example::Name>().begin()));
+    assert(test.at<Example::Name>(4) == "kept" && test.at<Example::Name>(5) == "kept");
+    assert(test.at<Example::NumItems>(4) + test.at<Example::NumItems>(5) == 201);
+    test.erase(4, 6);
+
     // Insertion is only done from an index and not an iterator to simplify implementation
     test.insert(0, vector3{ 11.f, 12.f, 13.f }, 14, 15.f, "first name", Checker{});
     assert(test.at<Example::Checker>(0).moveCtor);
@@ -286,6 +384,481 @@ int main()
             return !std::get<std::string&>(_element).empty();
         });
 
+    // Iterators are random access iterators. Dereferencing them gives a soa::row_reference, a tuple of references
+    // whose assignment and swap apply to the referenced members, so standard algorithms work directly on the columns.
+    {
+        std::sort(test.begin<Example::NumItems, Example::Life>(), test.end<Example::NumItems, Example::Life>());
+        assert(std::is_sorted(test.cbegin<Example::NumItems, Example::Life>(), test.cend<Example::NumItems, Example::Life>()));
+
+        ExampleArray::iterator it = test.begin();
+        std::iter_swap(it, it + 1);
+        assert(it[1].get<static_cast<size_t>(Example::NumItems)>() == test.at<Example::NumItems>(1));
+
+        auto [itemsRef, lifeRef] = *test.begin<Example::NumItems, Example::Life>();
+        itemsRef = 3;
+        assert(test.at<Example::NumItems>(0) == 3);
+        (void)lifeRef;
+    }
+
+    // Indexed iterators only hold a pointer to the column table of the container and a row index:
+    // advancing them is a single addition whatever the number of members, and they survive reallocations.
+    {
+        ExampleArray::partial_indexed_iterator<Example::NumItems, Example::Life> it = test.indexed_begin<Example::NumItems, Example::Life>();
+        test.reserve(test.capacity() * 2);
+        for (; it != test.indexed_end<Example::NumItems, Example::Life>(); ++it)
+            it.value<Example::Life>() = static_cast<float>(it.value<Example::NumItems>());
+
+        ExampleArray::const_indexed_iterator constIt = std::as_const(test).indexed_begin();
+        assert(test.indexed_cend() - constIt == static_cast<std::ptrdiff_t>(test.size()));
+    }
+
+    // Columns can be accessed as contiguous spans, and a range of rows as a view which doesn't copy anything.
+    {
+        soa::span<float> lifes = test.column<Example::Life>();
+        assert(lifes.size() == test.size() && lifes.data() == &test.at<Example::Life>(0));
+        for (float& life : lifes)
+            life += 1.f;
+
+        ExampleArray::partial_view<Example::NumItems, Example::Life> rows = test.slice<Example::NumItems, Example::Life>(1, test.size());
+        assert(rows.size() == test.size() - 1);
+        assert(&rows.at<Example::Life>(0) == &test.at<Example::Life>(1));
+        for (auto [numItems, life] : rows.slice(1, rows.size()))
+            life = static_cast<float>(numItems);
+
+        // Like the slices of the container, the slices of a view are checked against its size
+        bool thrown{ false };
+        try
+        {
+            (void)rows.slice(1, rows.size() + 1);
+        }
+        catch (const std::out_of_range&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+
+        ExampleArray::const_view all = std::as_const(test).slice();
+        assert(all.column<Example::Name>().size() == test.size());
+    }
+
+    // Rows can be sorted on one or several members. Only the key columns are used to compute the order,
+    // and every column is then reordered in place, once.
+    {
+        test.push_back(vector3{ 1.f, 2.f, 3.f }, 2, -1.f, "second name", Checker{});
+        test.sort<Example::Life>();
+        for (size_t i = 1; i < test.size(); ++i)
+            assert(test.at<Example::Life>(i - 1) <= test.at<Example::Life>(i));
+
+        // With a custom comparison, receiving tuples of the key members
+        test.sort_by<Example::NumItems, Example::Name>(std::greater<>{});
+        for (size_t i = 1; i < test.size(); ++i)
+            assert(test.at<Example::NumItems>(i - 1) >= test.at<Example::NumItems>(i));
+
+        // Or on a key computed from some members, for instance the Morton code of a position, to improve the locality of the rows
+        const auto morton = [](const vector3& _position) {
+            const auto spread = [](float _coordinate) {
+                uint32_t bits{ static_cast<uint32_t>(_coordinate < 0.f ? 0.f : _coordinate) & 0x3FF };
+                bits = (bits | (bits << 16)) & 0x030000FF;
+                bits = (bits | (bits << 8)) & 0x0300F00F;
+                bits = (bits | (bits << 4)) & 0x030C30C3;
+                return (bits | (bits << 2)) & 0x09249249;
+            };
+            return spread(_position.x) | (spread(_position.y) << 1) | (spread(_position.z) << 2);
+        };
+        test.push_back(vector3{ 5.f, 1.f, 0.f }, 3, 0.f, "east", Checker{});
+        test.push_back(vector3{ 0.f, 6.f, 2.f }, 4, 0.f, "north", Checker{});
+        test.reorder_by<Example::Position>(morton);
+        for (size_t i = 1; i < test.size(); ++i)
+            assert(morton(test.at<Example::Position>(i - 1)) <= morton(test.at<Example::Position>(i)));
+
+        // Or by an explicit permutation: row i receives the former row order[i]
+        const std::string lastName{ test.at<Example::Name>(test.size() - 1) };
+        std::vector<size_t> order(test.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = order.size() - 1 - i;
+        test.apply_permutation(order, soa::par);
+        assert(test.at<Example::Name>(0) == lastName);
+
+        // Permuting each column on its own thread
+        const ExampleArray before{ test };
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = (i + 2) % order.size();
+        test.apply_permutation(order, soa::parallel_policy{ 2, 1 });
+        for (size_t i = 0; i < test.size(); ++i)
+        {
+            assert(test.at<Example::Position>(i).x == before.at<Example::Position>(order[i]).x);
+            assert(test.at<Example::Position>(i).y == before.at<Example::Position>(order[i]).y);
+            assert(test.at<Example::NumItems>(i) == before.at<Example::NumItems>(order[i]));
+            assert(test.at<Example::Name>(i) == before.at<Example::Name>(order[i]));
+        }
+    }
+
+    // From 64 rows, a single arithmetic key is sorted with a radix sort, giving the order of std::stable_sort:
+    // negative floats, -0 and +0 being equal, and signed 64 bits keys
+    {
+        SampleArray samples;
+        for (int i = 0; i < 300; ++i)
+        {
+            const float value{ i % 7 == 0 ? (i % 2 == 0 ? 0.f : -0.f) : static_cast<float>((i * 53) % 101 - 50) * 0.25f };
+            const int64_t key{ (static_cast<int64_t>((i * 31) % 211) - 105) * (int64_t{ 1 } << 40) + i % 3 };
+            samples.push_back(value, key, i);
+        }
+
+        const auto check = [&samples](auto _sort, auto _less) {
+            SampleArray sorted{ samples };
+            _sort(sorted);
+            std::vector<int> rows(samples.size());
+            std::iota(rows.begin(), rows.end(), 0);
+            std::stable_sort(rows.begin(), rows.end(), [&samples, &_less](int _lhs, int _rhs) {
+                return _less(samples.value_at(static_cast<size_t>(_lhs)), samples.value_at(static_cast<size_t>(_rhs)));
+            });
+            for (size_t i = 0; i < rows.size(); ++i)
+                assert(sorted.at<Sample::Row>(i) == rows[i]);
+        };
+        check([](SampleArray& _samples) { _samples.sort<Sample::Value>(); },
+            [](const auto& _lhs, const auto& _rhs) { return soa::get<0>(_lhs) < soa::get<0>(_rhs); });
+        check([](SampleArray& _samples) { _samples.sort<Sample::Key>(); },
+            [](const auto& _lhs, const auto& _rhs) { return soa::get<1>(_lhs) < soa::get<1>(_rhs); });
+        check([](SampleArray& _samples) { _samples.reorder_by<Sample::Key>([](int64_t _key) { return -_key; }); },
+            [](const auto& _lhs, const auto& _rhs) { return -soa::get<1>(_lhs) < -soa::get<1>(_rhs); });
+        check([](SampleArray& _samples) { _samples.sort<Sample::Key, Sample::Value>(); }, [](const auto& _lhs, const auto& _rhs) {
+            return std::make_pair(soa::get<1>(_lhs), soa::get<0>(_lhs)) < std::make_pair(soa::get<1>(_rhs), soa::get<0>(_rhs));
+        });
+    }
+
+    // Queries select rows from a predicate on some members, evaluated on blocks of rows without branches,
+    // and the selection drives the other operations
+    {
+        const soa::selection selected{ test.select<Example::Life, Example::NumItems>([](float _life, int _numItems) { return (_life < 0.f) & (_numItems > 3); }) };
+        for (size_t row : selected)
+            assert(test.at<Example::Life>(row) < 0.f && test.at<Example::NumItems>(row) > 3);
+
+        // The same query evaluated one column at a time, a predicate per member
+        const soa::selection byColumns{ test.select_columns<Example::Life, Example::NumItems>([](float _life) { return _life < 0.f; }, [](int _numItems) { return _numItems > 3; }) };
+        assert(byColumns.size() == selected.size() && std::equal(byColumns.begin(), byColumns.end(), selected.begin()));
+
+        test.for_each<Example::Life>(selected, [](float& _life) { _life = 0.f; });
+        ExampleArray extracted{ test.gather(selected) };
+        assert(extracted.size() == selected.size());
+
+        // Or a bitmask, to combine several queries
+        const soa::bitmask alive{ test.select_mask<Example::Life>([](float _life) { return _life > 0.f; }) };
+        const soa::bitmask named{ test.select_mask<Example::Name>([](const std::string& _name) { return !_name.empty(); }) };
+        assert((alive & named).count() <= alive.count());
+    }
+
+    // Arithmetic columns are reduced by kernels compiled for the instruction sets of the processor,
+    // optionally splitting the rows between threads
+    {
+        ExampleArray samples;
+        for (int i = 0; i < 1000; ++i)
+            samples.push_back(vector3{}, (i * 37) % 1001 - 500, static_cast<float>(i % 41 - 20) * 0.5f, "sample", Checker{});
+
+        // Expected results, from scalar loops (the values of Life are exact in float)
+        float lifeSum{};
+        int minItems{ samples.at<Example::NumItems>(0) };
+        int maxItems{ minItems };
+        size_t alive{};
+        std::vector<size_t> lifeBins(8);
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const float life{ samples.at<Example::Life>(i) };
+            const int numItems{ samples.at<Example::NumItems>(i) };
+            lifeSum += life;
+            minItems = numItems < minItems ? numItems : minItems;
+            maxItems = numItems > maxItems ? numItems : maxItems;
+            alive += life > 0.f ? 1 : 0;
+            if (life >= -8.f && life < 8.f)
+                ++lifeBins[static_cast<size_t>((life + 8.f) / 2.f)];
+        }
+
+        // Sequentially, split between the hardware threads when large enough, and split in 4 parts whatever the size
+        const auto check = [&](const auto& _policy) {
+            assert(soa::sum<Example::Life>(samples, _policy) == lifeSum);
+            assert(soa::minmax<Example::NumItems>(samples, _policy) == std::make_pair(minItems, maxItems));
+            assert(soa::max<Example::NumItems>(samples, _policy) == maxItems);
+            assert(soa::count_if<Example::Life>(samples, [](float _life) { return _life > 0.f; }, _policy) == alive);
+
+            const auto lifeHistogram{ soa::histogram<Example::Life>(samples, -8.f, 8.f, 8, _policy) };
+            assert(std::equal(lifeHistogram.begin(), lifeHistogram.end(), lifeBins.begin(), lifeBins.end()));
+        };
+        check(soa::seq);
+        check(soa::par);
+        check(soa::parallel_policy{ 4, 1 });
+    }
+
+    // Large tables are updated by chunks of rows, run on a pool of threads, each chunk receiving the iterators of the selected members
+    {
+        for (int i = 0; i < 1000; ++i)
+            test.push_back(vector3{ 0.f, 0.f, 0.f }, i, 1.f, "chunk", Checker{});
+
+        // The grain doesn't divide the size, so the last chunk is shorter
+        const size_t grain{ 67 };
+        assert(test.size() % grain != 0);
+        soa::parallel_for_each<Example::NumItems, Example::Life>(test, [](auto _first, auto _last) {
+            for (auto it = _first; it != _last; ++it)
+                it.template value<Example::Life>() = static_cast<float>(it.template value<Example::NumItems>());
+        }, grain);
+        for (size_t i = 0; i < test.size(); ++i)
+            assert(test.at<Example::Life>(i) == static_cast<float>(test.at<Example::NumItems>(i)));
+
+        // With a pool of the application, or any executor providing bulk_execute(tasks, task)
+        soa::thread_pool pool{ 2 };
+        soa::parallel_for_each<Example::Life>(test, [](auto _first, auto _last) {
+            for (auto it = _first; it != _last; ++it)
+                it.template value<Example::Life>() *= 0.5f;
+        }, grain, pool);
+        for (size_t i = 0; i < test.size(); ++i)
+            assert(test.at<Example::Life>(i) == static_cast<float>(test.at<Example::NumItems>(i)) * 0.5f);
+    }
+
+    // Several threads append rows at the same time in the reserved capacity, the published rows being readable meanwhile
+    {
+        EventArray events;
+        events.reserve(64);
+        {
+            EventArray::concurrent_appender appender{ events.appender() };
+            std::thread producer{ [&appender] {
+                for (int i = 0; i < 40; ++i)
+                    appender.push_back(static_cast<double>(i), 1);
+            } };
+            for (int i = 0; i < 40; ++i)
+                appender.push_back(static_cast<double>(i), 0);
+            assert(appender.published_rows<Event::Source>().size() <= 80);
+            producer.join();
+
+            // The rows beyond the capacity were kept aside, and are moved to the container by commit
+            assert(appender.published() == 64 && appender.overflow_size() == 16);
+            appender.commit();
+        }
+        assert(events.size() == 80);
+    }
+
+    // Or each thread fills its own shard, without any contention, and the shards are concatenated once done
+    {
+        soa::sharded_vector<Event, double, int> shards{ 4 };
+        soa::thread_pool::shared().bulk_execute(shards.shard_count(), [&shards](size_t _shard) {
+            for (int i = 0; i < 10; ++i)
+                shards.shard(_shard).push_back(static_cast<double>(i), static_cast<int>(_shard));
+        });
+
+        // The rows of all the shards can be read as a single range
+        size_t count{};
+        for (auto it = shards.begin<Event::Source>(); it != shards.end<Event::Source>(); ++it)
+            count += it.shard() == static_cast<size_t>(it.value<Event::Source>()) ? 1 : 0;
+        assert(count == 40);
+
+        // Or concatenated column by column, by several threads
+        EventArray events{ shards.merge(soa::par) };
+        assert(events.size() == 40 && shards.empty());
+        assert(events.at<Event::Source>(39) == 3);
+    }
+
+    // Snapshots are immutable versions of the rows, read by other threads without any lock while the container is modified:
+    // only the chunks of the modified columns are copied
+    {
+        ExampleVersions entities;
+        for (int i = 0; i < 3000; ++i)
+            entities.push_back(vector3{}, i, 1.f, "entity", Checker{});
+
+        const ExampleVersions::version frame{ entities.snapshot() };
+        entities.at<Example::Life>(0) = 0.f;
+        assert(frame.at<Example::Life>(0) == 1.f);
+        assert(frame.column<Example::NumItems>(0).data() == std::as_const(entities).column<Example::NumItems>(0).data());
+
+        std::thread reader{ [&frame] {
+            float life{};
+            frame.for_each<Example::Life>([&life](float _life) { life += _life; });
+            assert(life == 3000.f);
+        } };
+        reader.join();
+    }
+
+    // Modifications mark the blocks of their columns: consumers visit only the dirty ranges, then clear the marks
+    {
+        ExampleTracked entities;
+        for (int i = 0; i < 1000; ++i)
+            entities.push_back(vector3{}, i, 1.f, "entity", Checker{});
+        entities.clear_dirty();
+
+        entities.at<Example::Life>(700) = 0.f;
+        for (auto it = entities.begin<Example::NumItems>() + 100; it != entities.begin<Example::NumItems>() + 110; ++it)
+            it.value<Example::NumItems>() *= 2;
+        assert(entities.is_dirty<Example::Life>(700) && !entities.is_dirty<Example::Life>(100));
+
+        size_t uploaded{};
+        entities.for_each_dirty<Example::Life>([&uploaded](size_t _first, size_t _last) { uploaded += _last - _first; });
+        assert(uploaded == 64);
+        entities.for_each_dirty([&uploaded](size_t _first, size_t _last) { uploaded += _last - _first; });
+        assert(uploaded == 64 + 128);
+
+        entities.clear_dirty<Example::Life>();
+        assert(!entities.is_dirty<Example::Life>(700) && entities.is_dirty<Example::NumItems>(100));
+    }
+
+    // A segmented vector never moves its rows: references stay valid while it grows
+    {
+        ExampleSegments segments;
+        segments.push_back(vector3{}, 1, 1.f, "first", Checker{});
+        const std::string& firstName = segments.at<Example::Name>(0);
+        for (int i = 0; i < 3000; ++i)
+            segments.push_back(vector3{}, i, 0.f, "row", Checker{});
+        assert(&firstName == &segments.at<Example::Name>(0));
+
+        // Rows are processed with the same iterators as the vector, or segment by segment on contiguous columns
+        for (auto it = segments.begin<Example::NumItems, Example::Life>(); it != segments.end<Example::NumItems, Example::Life>(); ++it)
+            it.value<Example::Life>() = static_cast<float>(it.value<Example::NumItems>());
+
+        size_t rows{};
+        for (size_t segment = 0; segment < segments.segment_count(); ++segment)
+            rows += segments.column<Example::Life>(segment).size();
+        assert(rows == segments.size());
+    }
+
+    // A tiled vector has the same element access and partial iterators, only the memory layout differs
+    {
+        ExampleTiles tiles;
+        for (int i = 0; i < 40; ++i)
+            tiles.push_back(vector3{}, i, 0.f, "row", Checker{});
+        assert(tiles.at<Example::NumItems>(39) == 39);
+
+        for (auto it = tiles.begin<Example::NumItems, Example::Life>(); it != tiles.end<Example::NumItems, Example::Life>(); ++it)
+            it.value<Example::Life>() = static_cast<float>(it.value<Example::NumItems>());
+
+        // Each tile holds contiguous arrays of its members
+        assert(tiles.tile_count() == 3 && tiles.column<Example::Life>(2).size() == 8);
+        assert(tiles.column<Example::Life>(1)[0] == 16.f);
+    }
+
+    // Tables allocated from an arena are released all at once, and moving them between containers
+    // using the same arena transfers their memory
+    {
+        soa::arena frameArena;
+        {
+            ExampleArenaArray frameRows{ soa::arena_allocator{ frameArena } };
+            for (int i = 0; i < 100; ++i)
+                frameRows.push_back(vector3{}, i, 0.f, "row", Checker{});
+
+            ExampleArenaArray kept{ soa::arena_allocator{ frameArena } };
+            const int* firstRow{ &frameRows.at<Example::NumItems>(0) };
+            kept = std::move(frameRows);
+            assert(&kept.at<Example::NumItems>(0) == firstRow);
+        }
+        frameArena.reset();
+    }
+
+    // Inline tables have the same interface
+    {
+        ExampleStatic inlineRows;
+        for (int i = 0; i < 32; ++i)
+            inlineRows.push_back(vector3{}, i, 0.f, "row", Checker{});
+        assert(inlineRows.capacity() == 32 && inlineRows.at<Example::NumItems>(31) == 31);
+
+        // Tables built from inline rows own their own inline block: moving them moves the rows
+        const soa::selection even{ inlineRows.select<Example::NumItems>([](int _numItems) { return _numItems % 2 == 0; }) };
+        auto gathered{ std::make_unique<decltype(inlineRows.gather(even))>(inlineRows.gather(even)) };
+        assert(gathered->size() == 16 && gathered->at<Example::NumItems>(15) == 30);
+        gathered->pop_back();
+        gathered->push_back(vector3{}, 32, 0.f, "row", Checker{});
+        assert(gathered->at<Example::NumItems>(15) == 32 && gathered->at<Example::Name>(0) == "row");
+
+        ExampleSmall smallRows;
+        for (int i = 0; i < 8; ++i)
+            smallRows.push_back(vector3{}, i, 0.f, "row", Checker{});
+        assert(smallRows.is_inline());
+        smallRows.push_back(vector3{}, 8, 0.f, "row", Checker{});
+        assert(!smallRows.is_inline());
+
+        // Back to the inline rows once small enough
+        smallRows.resize(4);
+        smallRows.shrink_to_fit();
+        assert(smallRows.is_inline() && smallRows.at<Example::NumItems>(3) == 3);
+
+        // Beyond the inline rows, allocators which can't be default constructed are given to the constructor,
+        // and copies allocate from the same arena
+        soa::arena smallArena;
+        soa::small_vector_base<Example, soa::arena_allocator, 8, vector3, int, float, std::string, Checker> arenaRows{ soa::arena_allocator{ smallArena } };
+        for (int i = 0; i < 20; ++i)
+            arenaRows.push_back(vector3{}, i, 0.f, "row", Checker{});
+        assert(!arenaRows.is_inline());
+        auto arenaCopy{ arenaRows };
+        assert(arenaCopy.get_allocator().fallback() == arenaRows.get_allocator().fallback());
+        assert(!arenaCopy.is_inline() && arenaCopy.at<Example::NumItems>(19) == 19);
+    }
+
+    // Grouped members are accessed like the others, and iterating on them reads a single stream of memory
+    {
+        ExampleGrouped grouped;
+        for (int i = 0; i < 10; ++i)
+            grouped.push_back(vector3{}, i, 0.f, "row", Checker{});
+        assert(&grouped.at<Example::NumItems>(3) == reinterpret_cast<const int*>(&grouped.at<Example::Position>(3) + 1));
+
+        for (auto it = grouped.begin<Example::Position, Example::NumItems>(); it != grouped.end<Example::Position, Example::NumItems>(); ++it)
+            it.value<Example::Position>().x = static_cast<float>(it.value<Example::NumItems>());
+        assert(grouped.at<Example::Position>(9).x == 9.f);
+
+        // Only the ungrouped members have a contiguous column
+        assert(grouped.column<Example::Life>().size() == 10);
+    }
+
+    // A slot map keeps its rows packed and returns handles on them: erasing a row moves the last one into it,
+    // and the handles of the moved row still find it, while the handles of the erased row are detected as stale
+    {
+        ExampleSlots slots;
+        const ExampleSlots::handle first{ slots.insert(vector3{}, 1, 0.f, "first", Checker{}) };
+        const ExampleSlots::handle second{ slots.insert(vector3{}, 2, 0.f, "second", Checker{}) };
+        const ExampleSlots::handle third{ slots.insert(vector3{}, 3, 0.f, "third", Checker{}) };
+
+        assert(slots.erase(first));
+        assert(!slots.contains(first) && !slots.erase(first));
+        assert(slots.at<Example::NumItems>(third) == 3 && slots.find(third) == 0);
+        assert(slots.at<Example::Name>(second) == "second");
+
+        // The slot is reused with a new generation
+        const ExampleSlots::handle fourth{ slots.insert(vector3{}, 4, 0.f, "fourth", Checker{}) };
+        assert(fourth.index == first.index && fourth != first && slots.handle_at(2) == fourth);
+
+        // Iterating goes through the packed rows
+        int numItems{};
+        for (auto it = slots.begin<Example::NumItems>(); it != slots.end<Example::NumItems>(); ++it)
+            numItems += it.value<Example::NumItems>();
+        assert(numItems == 9);
+    }
+
+    // An indexed vector finds its rows from their key member, and updates its index when the rows move
+    {
+        ExampleIndexed indexed;
+        for (int i = 0; i < 100; ++i)
+            indexed.push_back(vector3{}, i * 10, 0.f, "row", Checker{});
+        assert(indexed.find<Example::NumItems>(420) == 42);
+        assert(indexed.find<Example::NumItems>(421) == ExampleIndexed::npos);
+
+        indexed.erase(0);
+        indexed.insert(10, vector3{}, 5, 0.f, "inserted", Checker{});
+        assert(indexed.find<Example::NumItems>(420) == 42 && indexed.at<Example::Name>(indexed.find<Example::NumItems>(5)) == "inserted");
+
+        // Keys can be duplicated, and are modified through the container
+        indexed.assign_key(0, 5);
+        assert(indexed.count<Example::NumItems>(5) == 2);
+    }
+
+    // A flat map keeps its rows sorted on its key, and searches only the key column
+    {
+        ExampleSorted sorted;
+        for (int i = 10; i > 0; --i)
+            assert(sorted.insert(vector3{}, i * 10, 0.f, "row", Checker{}).second);
+        assert(!sorted.insert(vector3{}, 50, 0.f, "duplicate", Checker{}).second);
+        assert(sorted.lower_bound(45) == 4 && sorted.find(50) == 4 && sorted.find(45) == ExampleSorted::npos);
+
+        // A batch sorted on the key is merged in a single pass, skipping the keys already present
+        ExampleSorted::rows_type batch;
+        for (int i = 0; i < 20; ++i)
+            batch.push_back(vector3{}, i * 5, 0.f, "batch", Checker{});
+        assert(sorted.insert_sorted(std::move(batch)) == 11);
+        assert(sorted.size() == 21 && sorted.at<Example::NumItems>(20) == 100);
+        assert(sorted.equal_range(55) == std::make_pair(size_t{ 11 }, size_t{ 12 }));
+    }
+
     // And... we are done!
     test.clear();
     assert(test.empty());
@@ -0,0 +1,67 @@
+// Statistics counters of the containers. SOA_STATS changes the layout of vector_base:
+// it must be defined in every translation unit of a program, or in none. The build defines it for this program.
+#ifndef SOA_STATS
+#define SOA_STATS
+#endif
+#include "soa/soa.h"
+
+#include <assert.h>
+#include <string>
+
+enum class Entry
+{
+    Name,
+    Value,
+    Count
+};
+
+// The names are moved when the rows are relocated, the values are trivially copyable
+using EntryArray = soa::vector<Entry, std::string, int>;
+
+// All the members being trivially copyable, the block grows with realloc
+using SampleArray = soa::vector<Entry, int, float>;
+
+int main()
+{
+    // Each column starts on a cache line: 4 strings take 128 bytes, and 4 ints 64 bytes
+    EntryArray entries;
+    entries.reserve(4);
+    assert(entries.stats().allocations == 1 && entries.stats().growths == 1 && entries.stats().frees == 0);
+    assert(entries.stats().bytes_allocated == 192);
+    assert(entries.stats().columns[0].bytes_allocated == 128 && entries.stats().columns[1].bytes_allocated == 64);
+
+    for (int i = 0; i < 4; ++i)
+        entries.push_back(std::to_string(i), i);
+    assert(entries.stats().allocations == 1 && entries.stats().moved() == 0);
+
+    // Growing to 8 rows relocates the 4 rows of each column
+    entries.push_back("4", 4);
+    assert(entries.stats().allocations == 2 && entries.stats().growths == 2 && entries.stats().frees == 1);
+    assert(entries.stats().bytes_allocated == 192 + 320);
+    assert(entries.stats().columns[0].moved == 4 && entries.stats().columns[1].moved == 4 && entries.stats().copied() == 0);
+
+    // Insertions and erasures move the following rows
+    entries.reset_stats();
+    entries.insert(1, "inserted", 10);
+    assert(entries.stats().moved() == 2 * 4);
+    entries.erase(0);
+    assert(entries.stats().moved() == 2 * (4 + 5));
+    entries.erase(1, 3);
+    assert(entries.stats().moved() == 2 * (4 + 5 + 2));
+    assert(entries.stats().allocations == 0 && entries.stats().copied() == 0);
+
+    // Copies allocate the size of the source, and copy each row once
+    const EntryArray copy{ entries };
+    assert(copy.stats().allocations == 1 && copy.stats().growths == 0 && copy.stats().bytes_allocated == 192);
+    assert(copy.stats().columns[0].copied == 3 && copy.stats().columns[1].copied == 3 && copy.stats().moved() == 0);
+
+    // Doubling the capacity from 1 to 128 rows: 8 growths, each one relocating the previous rows
+    SampleArray samples;
+    for (int i = 0; i < 100; ++i)
+        samples.push_back(i, 0.f);
+    assert(samples.stats().allocations == 8 && samples.stats().growths == 8 && samples.stats().frees == 7);
+    assert(samples.stats().bytes_allocated == 2432);
+    assert(samples.stats().columns[0].moved == 127 && samples.stats().columns[1].moved == 127);
+
+    return 0;
+}